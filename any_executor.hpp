@@ -0,0 +1,682 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include "execution.hpp"
+#include <functional>
+#include <new>
+#include <optional>
+#include "pool_allocator.hpp"
+#include "stop_token.hpp"
+#include <type_traits>
+#include <utility>
+
+
+// any_executor and any_scheduler erase the type of an executor or scheduler behind a hand-rolled vtable
+//
+// the erased executor or scheduler is stored inline, so copying them never allocates. the invocables
+// any_executor executes travel to the underlying executor inside an any_invocable, which stores them
+// in an inline buffer. the operations connected to any_scheduler's senders store the underlying
+// operation in an inline buffer of their own. only objects too large for their buffers are allocated,
+// from pool_allocator
+
+
+namespace execution
+{
+namespace detail
+{
+
+
+template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
+struct erased_storage
+{
+  alignas(Alignment) std::byte bytes_[Size];
+};
+
+
+template<class T, std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
+inline constexpr bool fits_in_storage_v = sizeof(T) <= Size and Alignment % alignof(T) == 0;
+
+
+template<class T>
+T& erased_cast(void* storage) noexcept
+{
+  return *std::launder(static_cast<T*>(storage));
+}
+
+template<class T>
+const T& erased_cast(const void* storage) noexcept
+{
+  return *std::launder(static_cast<const T*>(storage));
+}
+
+
+// constructs the T returned by make() in storage drawn from pool_allocator
+template<class T, class F>
+T* pool_construct(F&& make)
+{
+  pool_allocator<T> alloc;
+  T* result = alloc.allocate(1);
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+  ::new(static_cast<void*>(result)) T(std::forward<F>(make)());
+#else
+  try
+  {
+    ::new(static_cast<void*>(result)) T(std::forward<F>(make)());
+  }
+  catch(...)
+  {
+    alloc.deallocate(result, 1);
+    throw;
+  }
+#endif
+
+  return result;
+}
+
+template<class T>
+void pool_destroy(T* p) noexcept
+{
+  p->~T();
+  pool_allocator<T>().deallocate(p, 1);
+}
+
+
+// any_invocable is a move-only nullary invocable of erased type
+// invocables which fit inline_size and move without throwing are stored inline
+class any_invocable
+{
+  public:
+    static constexpr std::size_t inline_size = 6 * sizeof(void*);
+
+    template<class F>
+      requires (!std::is_same_v<remove_cvref_t<F>, any_invocable> and invocable<remove_cvref_t<F>&>)
+    explicit any_invocable(F&& f)
+      : vtable_(&vtable_for<remove_cvref_t<F>>)
+    {
+      using T = remove_cvref_t<F>;
+
+      if constexpr(stored_inline<T>)
+      {
+        ::new(storage_.bytes_) T(std::forward<F>(f));
+      }
+      else
+      {
+        ::new(storage_.bytes_) T*(pool_construct<T>([&]{ return T(std::forward<F>(f)); }));
+      }
+    }
+
+    any_invocable(any_invocable&& other) noexcept
+      : vtable_(other.vtable_)
+    {
+      vtable_->move(storage_.bytes_, other.storage_.bytes_);
+    }
+
+    ~any_invocable()
+    {
+      vtable_->destroy(storage_.bytes_);
+    }
+
+    void operator()()
+    {
+      vtable_->invoke(storage_.bytes_);
+    }
+
+  private:
+    struct vtable
+    {
+      void (*invoke)(void*);
+      void (*move)(void*, void*) noexcept;
+      void (*destroy)(void*) noexcept;
+    };
+
+    template<class T>
+    static constexpr bool stored_inline = fits_in_storage_v<T, inline_size> and std::is_nothrow_move_constructible_v<T>;
+
+    template<class T>
+    static T& get(void* storage) noexcept
+    {
+      if constexpr(stored_inline<T>)
+      {
+        return erased_cast<T>(storage);
+      }
+      else
+      {
+        return *erased_cast<T*>(storage);
+      }
+    }
+
+    template<class T>
+    static constexpr vtable vtable_for =
+    {
+      [](void* storage)
+      {
+        std::invoke(get<T>(storage));
+      },
+      [](void* to, void* from) noexcept
+      {
+        if constexpr(stored_inline<T>)
+        {
+          ::new(to) T(std::move(erased_cast<T>(from)));
+        }
+        else
+        {
+          ::new(to) T*(std::exchange(erased_cast<T*>(from), nullptr));
+        }
+      },
+      [](void* storage) noexcept
+      {
+        if constexpr(stored_inline<T>)
+        {
+          erased_cast<T>(storage).~T();
+        }
+        else if(T* p = erased_cast<T*>(storage))
+        {
+          pool_destroy(p);
+        }
+      }
+    };
+
+    erased_storage<inline_size> storage_;
+    const vtable* vtable_;
+};
+
+
+// the vtable entries common to erased executors and schedulers
+struct erased_executor_vtable
+{
+  void (*copy)(void*, const void*) noexcept;
+  void (*destroy)(void*) noexcept;
+  bool (*equal)(const void*, const void*);
+};
+
+template<class E>
+inline constexpr erased_executor_vtable erased_executor_vtable_for =
+{
+  [](void* to, const void* from) noexcept
+  {
+    ::new(to) E(erased_cast<E>(from));
+  },
+  [](void* storage) noexcept
+  {
+    erased_cast<E>(storage).~E();
+  },
+  [](const void* a, const void* b)
+  {
+    return erased_cast<E>(a) == erased_cast<E>(b);
+  }
+};
+
+
+// erased_executor stores an executor or scheduler inline and dispatches through Vtable, which
+// derives from erased_executor_vtable
+// the erased object must fit inline_size and copy without throwing, so that erased_executor does too
+template<class Vtable>
+class erased_executor
+{
+  public:
+    static constexpr std::size_t inline_size = 3 * sizeof(void*);
+
+    template<class E>
+    static constexpr bool erasable = fits_in_storage_v<E, inline_size, alignof(void*)> and std::is_nothrow_copy_constructible_v<E>;
+
+    erased_executor(const erased_executor& other) noexcept
+      : vtable_(other.vtable_)
+    {
+      vtable_->copy(storage_.bytes_, other.storage_.bytes_);
+    }
+
+    erased_executor& operator=(const erased_executor& other) noexcept
+    {
+      if(this != &other)
+      {
+        vtable_->destroy(storage_.bytes_);
+        vtable_ = other.vtable_;
+        vtable_->copy(storage_.bytes_, other.storage_.bytes_);
+      }
+
+      return *this;
+    }
+
+    ~erased_executor()
+    {
+      vtable_->destroy(storage_.bytes_);
+    }
+
+  protected:
+    template<class E>
+    erased_executor(const E& ex, const Vtable* vtable) noexcept
+      : vtable_(vtable)
+    {
+      ::new(storage_.bytes_) E(ex);
+    }
+
+    // erased executors are equal when they erase the same type and the erased objects are equal
+    bool equals(const erased_executor& other) const
+    {
+      return vtable_ == other.vtable_ and vtable_->equal(storage_.bytes_, other.storage_.bytes_);
+    }
+
+    erased_storage<inline_size, alignof(void*)> storage_;
+    const Vtable* vtable_;
+};
+
+
+struct any_executor_vtable : erased_executor_vtable
+{
+  void (*execute)(const void*, any_invocable&&);
+};
+
+template<class E>
+inline constexpr any_executor_vtable any_executor_vtable_for =
+{
+  erased_executor_vtable_for<E>,
+  [](const void* ex, any_invocable&& f)
+  {
+    execution::execute(erased_cast<E>(ex), std::move(f));
+  }
+};
+
+
+} // end detail
+
+
+// any_executor is an executor of erased type
+class any_executor : public detail::erased_executor<detail::any_executor_vtable>
+{
+  public:
+    template<class E>
+      requires (!std::is_same_v<E, any_executor> and executor<E> and erasable<E>)
+    explicit any_executor(const E& ex) noexcept
+      : erased_executor(ex, &detail::any_executor_vtable_for<E>)
+    {}
+
+    template<class F>
+      requires invocable<remove_cvref_t<F>&>
+    void execute(F&& f) const
+    {
+      vtable_->execute(storage_.bytes_, detail::any_invocable(std::forward<F>(f)));
+    }
+
+    friend bool operator==(const any_executor& a, const any_executor& b)
+    {
+      return a.equals(b);
+    }
+
+    friend bool operator!=(const any_executor& a, const any_executor& b)
+    {
+      return !(a == b);
+    }
+};
+
+
+namespace detail
+{
+
+
+// erased_receiver is the receiver of void any_scheduler's senders connect to the underlying sender
+// it refers to the operation which connected it, whose receiver it completes
+class erased_receiver
+{
+  public:
+    struct vtable
+    {
+      void (*set_value)(void*);
+      void (*set_error)(void*, execution::error_type) noexcept;
+      void (*set_done)(void*) noexcept;
+      in_place_stop_token (*get_stop_token)(const void*) noexcept;
+    };
+
+    erased_receiver(void* op, const vtable* vtable) noexcept
+      : op_(op),
+        vtable_(vtable)
+    {}
+
+    void set_value() &&
+    {
+      vtable_->set_value(op_);
+    }
+
+    void set_error(execution::error_type e) && noexcept
+    {
+      vtable_->set_error(op_, std::move(e));
+    }
+
+    void set_done() && noexcept
+    {
+      vtable_->set_done(op_);
+    }
+
+    in_place_stop_token get_stop_token() const noexcept
+    {
+      return vtable_->get_stop_token(op_);
+    }
+
+  private:
+    void* op_;
+    const vtable* vtable_;
+};
+
+
+struct erased_operation_vtable
+{
+  void (*start)(void*) noexcept;
+  void (*destroy)(void*) noexcept;
+};
+
+template<class Op>
+inline constexpr erased_operation_vtable inline_operation_vtable_for =
+{
+  [](void* storage) noexcept
+  {
+    execution::start(erased_cast<Op>(storage));
+  },
+  [](void* storage) noexcept
+  {
+    erased_cast<Op>(storage).~Op();
+  }
+};
+
+template<class Op>
+inline constexpr erased_operation_vtable pool_operation_vtable_for =
+{
+  [](void* storage) noexcept
+  {
+    execution::start(*erased_cast<Op*>(storage));
+  },
+  [](void* storage) noexcept
+  {
+    pool_destroy(erased_cast<Op*>(storage));
+  }
+};
+
+
+// the size of the buffer in which any_scheduler's operations store the underlying operation
+inline constexpr std::size_t erased_operation_inline_size = 8 * sizeof(void*);
+
+
+struct any_scheduler_vtable : erased_executor_vtable
+{
+  // constructs the operation connecting the scheduler's sender to r in storage
+  const erased_operation_vtable* (*connect)(const void*, void*, erased_receiver);
+};
+
+template<class S>
+inline constexpr any_scheduler_vtable any_scheduler_vtable_for =
+{
+  erased_executor_vtable_for<S>,
+  [](const void* sched, void* storage, erased_receiver r) -> const erased_operation_vtable*
+  {
+    using operation_type = connect_result_t<decltype(execution::schedule(std::declval<const S&>())), erased_receiver>;
+
+    auto make = [&]
+    {
+      return execution::connect(execution::schedule(erased_cast<S>(sched)), std::move(r));
+    };
+
+    if constexpr(fits_in_storage_v<operation_type, erased_operation_inline_size>)
+    {
+      ::new(storage) operation_type(make());
+      return &inline_operation_vtable_for<operation_type>;
+    }
+    else
+    {
+      ::new(storage) operation_type*(pool_construct<operation_type>(make));
+      return &pool_operation_vtable_for<operation_type>;
+    }
+  }
+};
+
+
+template<class R>
+class any_scheduler_operation
+{
+  public:
+    template<class OtherR>
+    any_scheduler_operation(const any_scheduler_vtable* vtable, const void* sched, OtherR&& r)
+      : receiver_(std::forward<OtherR>(r)),
+        operation_vtable_(vtable->connect(sched, storage_.bytes_, erased_receiver{this, &receiver_vtable}))
+    {}
+
+    // the erased receiver refers to this object, so it must not move
+    any_scheduler_operation(any_scheduler_operation&&) = delete;
+
+    ~any_scheduler_operation()
+    {
+      operation_vtable_->destroy(storage_.bytes_);
+    }
+
+    void start() noexcept
+    {
+      if constexpr(forwards_stop)
+      {
+        stop_.callback_.emplace(execution::get_stop_token(receiver_), forward_stop{this});
+      }
+
+      operation_vtable_->start(storage_.bytes_);
+    }
+
+  private:
+    using stop_token_type = stop_token_of_t<const R&>;
+
+    // the erased receiver's stop token is an in_place_stop_token, so other stop tokens are forwarded to one
+    static constexpr bool forwards_stop =
+      !std::is_same_v<stop_token_type, in_place_stop_token> and
+      !std::is_same_v<stop_token_type, never_stop_token>
+    ;
+
+    struct forward_stop
+    {
+      any_scheduler_operation* op_;
+
+      void operator()() const noexcept
+      {
+        op_->forward_stop_request();
+      }
+    };
+
+    enum class completion_type : unsigned char { value, error, done };
+
+    struct stop_forwarding
+    {
+      in_place_stop_source source_;
+      std::optional<typename stop_token_type::template callback_type<forward_stop>> callback_;
+
+      // one count for the erased operation's completion, and one for each forwarded stop request in progress
+      std::atomic<std::size_t> num_outstanding_{1};
+      completion_type completion_;
+      std::optional<execution::error_type> error_;
+    };
+
+    struct no_stop_forwarding {};
+
+    static any_scheduler_operation& self(void* op) noexcept
+    {
+      return *static_cast<any_scheduler_operation*>(op);
+    }
+
+    // the erased operation may complete inside the request_stop which a forwarded stop request makes, and
+    // the receiver may then destroy this object before request_stop returns. so the request holds a count
+    // of its own, and whichever of it and the erased operation's completion arrives last completes the
+    // receiver. no count remains once that has begun, and it waits for this callback to return
+    void forward_stop_request() noexcept
+    {
+      std::size_t n = stop_.num_outstanding_.load(std::memory_order_relaxed);
+
+      do
+      {
+        if(n == 0)
+        {
+          return;
+        }
+      }
+      while(!stop_.num_outstanding_.compare_exchange_weak(n, n + 1, std::memory_order_acquire, std::memory_order_relaxed));
+
+      stop_.source_.request_stop();
+      arrive();
+    }
+
+    void complete(completion_type completion) noexcept
+    {
+      stop_.completion_ = completion;
+      arrive();
+    }
+
+    void arrive() noexcept
+    {
+      if(stop_.num_outstanding_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+      {
+        return;
+      }
+
+      stop_.callback_.reset();
+
+      switch(stop_.completion_)
+      {
+        case completion_type::value:
+        {
+          detail::set_value_or_error(std::move(receiver_));
+          break;
+        }
+
+        case completion_type::error:
+        {
+          execution::set_error(std::move(receiver_), std::move(*stop_.error_));
+          break;
+        }
+
+        case completion_type::done:
+        {
+          execution::set_done(std::move(receiver_));
+          break;
+        }
+      }
+    }
+
+    static constexpr erased_receiver::vtable receiver_vtable =
+    {
+      [](void* op)
+      {
+        if constexpr(forwards_stop)
+        {
+          self(op).complete(completion_type::value);
+        }
+        else
+        {
+          execution::set_value(std::move(self(op).receiver_));
+        }
+      },
+      [](void* op, execution::error_type e) noexcept
+      {
+        if constexpr(forwards_stop)
+        {
+          self(op).stop_.error_.emplace(std::move(e));
+          self(op).complete(completion_type::error);
+        }
+        else
+        {
+          execution::set_error(std::move(self(op).receiver_), std::move(e));
+        }
+      },
+      [](void* op) noexcept
+      {
+        if constexpr(forwards_stop)
+        {
+          self(op).complete(completion_type::done);
+        }
+        else
+        {
+          execution::set_done(std::move(self(op).receiver_));
+        }
+      },
+      [](const void* op) noexcept -> in_place_stop_token
+      {
+        const any_scheduler_operation& self = *static_cast<const any_scheduler_operation*>(op);
+
+        if constexpr(std::is_same_v<stop_token_type, in_place_stop_token>)
+        {
+          return execution::get_stop_token(self.receiver_);
+        }
+        else if constexpr(forwards_stop)
+        {
+          return self.stop_.source_.get_token();
+        }
+        else
+        {
+          return {};
+        }
+      }
+    };
+
+    R receiver_;
+    [[no_unique_address]] std::conditional_t<forwards_stop, stop_forwarding, no_stop_forwarding> stop_;
+    erased_storage<erased_operation_inline_size> storage_;
+    const erased_operation_vtable* operation_vtable_;
+};
+
+
+} // end detail
+
+
+// any_scheduler is a scheduler of erased type
+class any_scheduler : public detail::erased_executor<detail::any_scheduler_vtable>
+{
+  public:
+    template<class S>
+      requires (!std::is_same_v<S, any_scheduler> and scheduler<S> and erasable<S>)
+    explicit any_scheduler(const S& sched) noexcept
+      : erased_executor(sched, &detail::any_scheduler_vtable_for<S>)
+    {}
+
+    template<receiver_of R>
+    using operation = detail::any_scheduler_operation<remove_cvref_t<R>>;
+
+    struct sender_type;
+
+    sender_type schedule() const noexcept;
+
+    friend bool operator==(const any_scheduler& a, const any_scheduler& b)
+    {
+      return a.equals(b);
+    }
+
+    friend bool operator!=(const any_scheduler& a, const any_scheduler& b)
+    {
+      return !(a == b);
+    }
+};
+
+
+struct any_scheduler::sender_type
+{
+  template<template<class...> class Tuple, template<class...> class Variant>
+  using value_types = Variant<Tuple<>>;
+
+  template<template<class...> class Variant>
+  using error_types = Variant<execution::error_type>;
+
+  static constexpr bool sends_done = true;
+
+  any_scheduler scheduler_;
+
+  template<receiver_of R>
+  operation<R> connect(R&& r) const
+  {
+    return {scheduler_.vtable_, scheduler_.storage_.bytes_, std::forward<R>(r)};
+  }
+};
+
+
+inline any_scheduler::sender_type any_scheduler::schedule() const noexcept
+{
+  return {*this};
+}
+
+
+} // end execution
+
+
+static_assert(execution::executor<execution::any_executor>);
+static_assert(execution::scheduler<execution::any_scheduler>);
@@ -0,0 +1,141 @@
+// $ clang-10 -std=c++20 -O3 -I.. any_executor.cpp -lstdc++ -lpthread
+
+// compares dispatch through any_executor and any_scheduler with dispatch through the concrete
+// scheduler they erase, a run_loop's, and with a naive erasure built from std::function
+//
+// the invocables capture three pointers, which is more than std::function stores inline, so the
+// naive erasure allocates for each one in addition to the run_loop's own allocation
+
+#include "harness.hpp"
+#include "any_executor.hpp"
+#include "execution.hpp"
+#include "run_loop.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+
+struct counting_receiver
+{
+  std::size_t* count_;
+
+  void set_value() && noexcept
+  {
+    ++*count_;
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+template<class Execute>
+void measure_execute(const char* name, run_loop& loop, Execute execute, std::size_t n)
+{
+  benchmark::measure(name, n, [&]
+  {
+    std::size_t count = 0;
+    std::size_t increment = 1;
+    std::size_t* unused = nullptr;
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      execute([&count, &increment, unused]
+      {
+        count += increment;
+        benchmark::do_not_optimize(unused);
+      });
+    }
+
+    loop.finish();
+    loop.run();
+
+    benchmark::do_not_optimize(count);
+  });
+}
+
+
+template<class Scheduler>
+void measure_connect(const char* name, run_loop& loop, const Scheduler& sched, std::size_t n)
+{
+  using operation_type = execution::connect_result_t<decltype(execution::schedule(sched)), counting_receiver>;
+  std::allocator<operation_type> alloc;
+  operation_type* operations = alloc.allocate(n);
+
+  benchmark::measure(name, n, [&]
+  {
+    std::size_t count = 0;
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      operation_type* op = ::new(static_cast<void*>(operations + i)) operation_type(
+        execution::connect(execution::schedule(sched), counting_receiver{&count})
+      );
+
+      execution::start(*op);
+    }
+
+    loop.finish();
+    loop.run();
+
+    benchmark::do_not_optimize(count);
+    std::destroy_n(operations, n);
+  });
+
+  alloc.deallocate(operations, n);
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 1'000'000;
+
+  {
+    run_loop loop;
+    auto sched = loop.scheduler();
+
+    measure_execute("execute(sched, f)", loop, [=](auto&& f)
+    {
+      execution::execute(sched, std::move(f));
+    }, n);
+  }
+
+  {
+    run_loop loop;
+    execution::any_executor ex(loop.scheduler());
+
+    measure_execute("execute(any_executor, f)", loop, [=](auto&& f)
+    {
+      execution::execute(ex, std::move(f));
+    }, n);
+  }
+
+  {
+    run_loop loop;
+    auto sched = loop.scheduler();
+
+    std::function<void(std::function<void()>)> ex = [=](std::function<void()> f)
+    {
+      execution::execute(sched, std::move(f));
+    };
+
+    measure_execute("std::function<void(std::function<void()>)>(f)", loop, [&](auto&& f)
+    {
+      ex(std::move(f));
+    }, n);
+  }
+
+  {
+    run_loop loop;
+    measure_connect("connect(schedule(sched), r) + start", loop, loop.scheduler(), n);
+  }
+
+  {
+    run_loop loop;
+    measure_connect("connect(schedule(any_scheduler), r) + start", loop, execution::any_scheduler(loop.scheduler()), n);
+  }
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+// $ clang-10 -std=c++20 -O3 -I.. bulk_execute.cpp -lstdc++ -lpthread
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+// hides thread_pool's native bulk_execute so that execution::bulk_execute takes its chunked fallback
+template<class Executor>
+struct without_bulk_execute
+{
+  Executor ex_;
+
+  template<class F>
+    requires invocable<remove_cvref_t<F>&>
+  void execute(F&& f) const
+  {
+    execution::execute(ex_, std::forward<F>(f));
+  }
+
+  friend bool operator==(const without_bulk_execute& a, const without_bulk_execute& b)
+  {
+    return a.ex_ == b.ex_;
+  }
+
+  friend bool operator!=(const without_bulk_execute& a, const without_bulk_execute& b)
+  {
+    return !(a == b);
+  }
+};
+
+
+void wait_for(const std::atomic<std::size_t>& count, std::size_t n)
+{
+  while(count.load(std::memory_order_relaxed) != n)
+  {
+    std::this_thread::yield();
+  }
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 10'000'000;
+
+  thread_pool pool;
+  auto ex = pool.executor();
+
+  std::vector<std::size_t> data(n);
+
+  benchmark::measure("execute(ex, f) per index", n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      execution::execute(ex, [&data,&count,i]
+      {
+        data[i] = i;
+        count.fetch_add(1, std::memory_order_relaxed);
+      });
+    }
+
+    wait_for(count, n);
+  });
+
+  benchmark::measure("bulk_execute(ex, f, n) [chunked fallback]", n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    execution::bulk_execute(without_bulk_execute<thread_pool::executor_type>{ex}, [&](std::size_t i)
+    {
+      data[i] = i;
+      count.fetch_add(1, std::memory_order_relaxed);
+    }, n);
+
+    wait_for(count, n);
+  });
+
+  benchmark::measure("bulk_execute(ex, f, n) [thread_pool]", n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    execution::bulk_execute(ex, [&](std::size_t i)
+    {
+      data[i] = i;
+      count.fetch_add(1, std::memory_order_relaxed);
+    }, n);
+
+    wait_for(count, n);
+  });
+
+  return 0;
+}
+
@@ -0,0 +1,82 @@
+// $ clang-10 -std=c++20 -fsyntax-only -ftime-trace -I.. compile_time.cpp
+// $ g++ -std=c++20 -fsyntax-only -ftime-report -I.. compile_time.cpp
+
+// measures the time taken to compile NUM_PAIRS distinct executor/receiver pairs through the
+// customization points, rather than the time taken to run them
+//
+// each pair checks the executor and scheduler concepts, connects a receiver to schedule(ex),
+// executes an invocable, and submits a receiver, which exercises each of the executor fallbacks
+// of schedule, connect, and submit. define NUM_PAIRS to scale the translation unit
+
+#include "execution.hpp"
+#include <cstddef>
+#include <utility>
+
+
+#ifndef NUM_PAIRS
+#define NUM_PAIRS 1000
+#endif
+
+
+template<std::size_t I>
+struct test_executor
+{
+  template<class F>
+  void execute(F&& f) const
+  {
+    f();
+  }
+
+  friend bool operator==(const test_executor&, const test_executor&) { return true; }
+  friend bool operator!=(const test_executor&, const test_executor&) { return false; }
+};
+
+
+template<std::size_t I>
+struct test_receiver
+{
+  int* count_;
+
+  void set_value() && noexcept
+  {
+    ++*count_;
+  }
+
+  void set_error(execution::error_type) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+template<std::size_t I>
+void instantiate(int& count)
+{
+  static_assert(execution::executor<test_executor<I>>);
+  static_assert(execution::scheduler<test_executor<I>>);
+
+  test_executor<I> ex;
+
+  auto op = execution::connect(execution::schedule(ex), test_receiver<I>{&count});
+  execution::start(op);
+
+  execution::execute(ex, [&count]{ ++count; });
+
+  execution::submit(ex, test_receiver<I>{&count});
+}
+
+
+template<std::size_t... Is>
+void instantiate_all(int& count, std::index_sequence<Is...>)
+{
+  (instantiate<Is>(count), ...);
+}
+
+
+int main()
+{
+  int count = 0;
+
+  instantiate_all(count, std::make_index_sequence<NUM_PAIRS>{});
+
+  return count == 3 * NUM_PAIRS ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+// $ clang-10 -std=c++20 -O3 -I.. connect.cpp -lstdc++
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "execution_context.hpp"
+#include <cstddef>
+
+
+struct counting_receiver
+{
+  std::size_t* count_;
+
+  void set_value() && noexcept
+  {
+    ++*count_;
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+// a receiver whose move constructor may throw cannot be moved into the invocable,
+// so connect's executor fallback adapts it through a pointer instead
+struct pinned_receiver : counting_receiver
+{
+  pinned_receiver(std::size_t* count) noexcept
+    : counting_receiver{count}
+  {}
+
+  pinned_receiver(pinned_receiver&& other) noexcept(false)
+    : counting_receiver{other.count_}
+  {}
+};
+
+
+int main()
+{
+  constexpr std::size_t n = 100'000'000;
+
+  execution_context ctx;
+  auto ex = ctx.executor();
+  std::size_t count = 0;
+
+  benchmark::measure("connect(schedule(ex), r) + start [as_invocable]", n, [&]
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      auto op = execution::connect(execution::schedule(ex), pinned_receiver{&count});
+      execution::start(op);
+      benchmark::do_not_optimize(op);
+    }
+  });
+
+  benchmark::measure("connect(schedule(ex), r) + start [as_value_invocable]", n, [&]
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      auto op = execution::connect(execution::schedule(ex), counting_receiver{&count});
+      execution::start(op);
+      benchmark::do_not_optimize(op);
+    }
+  });
+
+  benchmark::do_not_optimize(count);
+
+  return 0;
+}
+
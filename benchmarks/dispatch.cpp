@@ -0,0 +1,241 @@
+// $ clang-10 -std=c++20 -O3 -I.. dispatch.cpp -lstdc++ -lpthread
+
+// measures every dispatch path through execute, connect, submit and schedule
+// on an inline executor, a single-thread queue and a thread pool
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "execution_context.hpp"
+#include "single_thread_context.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+
+
+struct counting_receiver
+{
+  std::atomic<std::size_t>* count_;
+
+  void set_value() && noexcept
+  {
+    count_->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+// a receiver whose move may throw, which connect's executor fallback adapts through as_invocable
+struct pinned_receiver : counting_receiver
+{
+  pinned_receiver(std::atomic<std::size_t>* count) noexcept
+    : counting_receiver{count}
+  {}
+
+  pinned_receiver(pinned_receiver&& other) noexcept(false)
+    : counting_receiver{other.count_}
+  {}
+};
+
+
+// a sender which customizes submit with a member function
+struct member_submit_sender : execution_context::scheduler_type::sender_type
+{
+  template<execution::receiver_of R>
+  void submit(R&& r) const
+  {
+    execution::set_value(std::forward<R>(r));
+  }
+};
+
+
+// a sender which customizes submit with a free function
+struct free_submit_sender : execution_context::scheduler_type::sender_type
+{
+  template<execution::receiver_of R>
+  friend void submit(const free_submit_sender&, R&& r)
+  {
+    execution::set_value(std::forward<R>(r));
+  }
+};
+
+
+void wait_for(const std::atomic<std::size_t>& count, std::size_t n)
+{
+  while(count.load(std::memory_order_relaxed) != n)
+  {
+    std::this_thread::yield();
+  }
+}
+
+
+// measures n calls of dispatch(count) which each eventually increment count once
+template<class F>
+void measure_dispatch(const std::string& name, std::size_t n, F dispatch)
+{
+  benchmark::measure(name.c_str(), n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      dispatch(count);
+    }
+
+    wait_for(count, n);
+  });
+}
+
+
+// measures n connects and starts; operation states live in preallocated storage until they complete
+template<class Receiver, class F>
+void measure_connect(const std::string& name, std::size_t n, F make_sender)
+{
+  using operation_type = execution::connect_result_t<decltype(make_sender()), Receiver>;
+
+  std::allocator<operation_type> alloc;
+  operation_type* operations = alloc.allocate(n);
+
+  benchmark::measure(name.c_str(), n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      operation_type* op = ::new(static_cast<void*>(operations + i)) operation_type(
+        execution::connect(make_sender(), Receiver{&count})
+      );
+
+      execution::start(*op);
+    }
+
+    wait_for(count, n);
+
+    std::destroy_n(operations, n);
+  });
+
+  alloc.deallocate(operations, n);
+}
+
+
+template<class Executor>
+void measure_executor(const std::string& executor_name, Executor ex, std::size_t n)
+{
+  auto name = [&](const char* path)
+  {
+    return executor_name + ": " + path;
+  };
+
+  // execute_t
+  measure_dispatch(name("execute(ex, f)"), n, [&](std::atomic<std::size_t>& count)
+  {
+    execution::execute(ex, [&count]
+    {
+      count.fetch_add(1, std::memory_order_relaxed);
+    });
+  });
+
+  if constexpr(requires { execution::execute(ex, counting_receiver{}); })
+  {
+    measure_dispatch(name("execute(ex, r)"), n, [&](std::atomic<std::size_t>& count)
+    {
+      execution::execute(ex, counting_receiver{&count});
+    });
+  }
+
+  // senders produced by as_sender cannot be adapted back into executors
+  if constexpr(requires { execution::execute(execution::schedule(ex), []{}); })
+  {
+    measure_dispatch(name("execute(schedule(ex), f) [as_receiver]"), n, [&](std::atomic<std::size_t>& count)
+    {
+      execution::execute(execution::schedule(ex), [&count]
+      {
+        count.fetch_add(1, std::memory_order_relaxed);
+      });
+    });
+  }
+
+  // connect_t
+  // inline executors take connect's is_inline_executor path for both receivers of the executor fallback
+  measure_connect<counting_receiver>(name("connect(schedule(ex), r) + start"), n, [&]
+  {
+    return execution::schedule(ex);
+  });
+
+  measure_connect<counting_receiver>(name("connect(ex, r) + start [executor fallback, by value]"), n, [&]
+  {
+    return ex;
+  });
+
+  measure_connect<pinned_receiver>(name("connect(ex, r) + start [executor fallback, by pointer]"), n, [&]
+  {
+    return ex;
+  });
+
+  // submit_t
+  measure_dispatch(name("submit(schedule(ex), r) [submit_receiver]"), n, [&](std::atomic<std::size_t>& count)
+  {
+    execution::submit(execution::schedule(ex), counting_receiver{&count});
+  });
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 1'000'000;
+
+  {
+    execution_context ctx;
+
+    measure_executor("inline", ctx.executor(), n);
+
+    // schedule_t
+    measure_connect<counting_receiver>("inline: connect(schedule(sched), r) + start [member schedule]", n, [&]
+    {
+      return execution::schedule(ctx.scheduler());
+    });
+
+    measure_connect<counting_receiver>("inline: connect(schedule(ex), r) + start [as_sender]", n, [&]
+    {
+      return execution::schedule(ctx.executor());
+    });
+
+    measure_dispatch("inline: execute(schedule(sched), f) [as_receiver]", n, [&](std::atomic<std::size_t>& count)
+    {
+      execution::execute(execution::schedule(ctx.scheduler()), [&count]
+      {
+        count.fetch_add(1, std::memory_order_relaxed);
+      });
+    });
+
+    // submit_t customizations
+    measure_dispatch("inline: submit(s, r) [member submit]", n, [&](std::atomic<std::size_t>& count)
+    {
+      execution::submit(member_submit_sender{{ctx}}, counting_receiver{&count});
+    });
+
+    measure_dispatch("inline: submit(s, r) [free submit]", n, [&](std::atomic<std::size_t>& count)
+    {
+      execution::submit(free_submit_sender{{ctx}}, counting_receiver{&count});
+    });
+  }
+
+  {
+    single_thread_context ctx;
+    measure_executor("single_thread_context", ctx.executor(), n);
+  }
+
+  {
+    thread_pool pool;
+    measure_executor("thread_pool", pool.executor(), n);
+  }
+
+  return 0;
+}
+
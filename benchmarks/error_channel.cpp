@@ -0,0 +1,172 @@
+// $ clang-10 -std=c++20 -O3 -I.. error_channel.cpp -lstdc++ -lpthread
+// $ clang-10 -std=c++20 -O3 -fno-exceptions -I.. error_channel.cpp -lstdc++ -lpthread
+
+// compares the error channel used with exceptions against the one selected by EXECUTION_NO_EXCEPTIONS,
+// which the second command defines implicitly
+//
+// with exceptions, adapting a receiver whose set_value may throw compiles a handler which delivers
+// a std::exception_ptr, and reporting an error allocates both the exception and the pointer's
+// refcounted storage. without them, no handler is compiled and errors are std::error_code values.
+// compare the output of the two builds, and the size of their code with size(1)
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "execution_context.hpp"
+#include "run_loop.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <system_error>
+#include <utility>
+
+
+// set_value is not noexcept, so adapting this receiver requires a handler when exceptions are enabled
+struct counting_receiver
+{
+  std::size_t* count_;
+
+  void set_value() &&
+  {
+    ++*count_;
+  }
+
+  void set_error(execution::error_type e) && noexcept
+  {
+    benchmark::do_not_optimize(e);
+    ++*count_;
+  }
+
+  void set_done() && noexcept {}
+};
+
+
+// the same executor without the is_inline_executor specialization
+struct opaque_executor
+{
+  execution_context::executor_type ex_;
+
+  template<class F>
+    requires invocable<F&>
+  void execute(F&& f) const
+  {
+    ex_.execute(std::forward<F>(f));
+  }
+
+  friend bool operator==(const opaque_executor& a, const opaque_executor& b)
+  {
+    return a.ex_ == b.ex_;
+  }
+
+  friend bool operator!=(const opaque_executor& a, const opaque_executor& b)
+  {
+    return !(a == b);
+  }
+};
+
+
+// the error an operation reports when a resource it needs is unavailable
+[[gnu::noinline]] execution::error_type make_error()
+{
+  std::error_code ec = std::make_error_code(std::errc::resource_unavailable_try_again);
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+  return ec;
+#else
+  return std::make_exception_ptr(std::system_error(ec));
+#endif
+}
+
+
+template<class Executor>
+void measure_connect(const char* name, Executor ex)
+{
+  constexpr std::size_t n = 100'000'000;
+  std::size_t count = 0;
+
+  benchmark::measure(name, n, [&]
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      auto op = execution::connect(execution::schedule(ex), counting_receiver{&count});
+      execution::start(op);
+      benchmark::do_not_optimize(op);
+    }
+  });
+
+  benchmark::do_not_optimize(count);
+}
+
+
+int main()
+{
+#if defined(EXECUTION_NO_EXCEPTIONS)
+  std::printf("error channel: std::error_code\n\n");
+#else
+  std::printf("error channel: std::exception_ptr\n\n");
+#endif
+
+  execution_context ctx;
+
+  using adapted_operation = execution::connect_result_t<opaque_executor, counting_receiver>;
+  using submitted_operation = execution::detail::submit_receiver<opaque_executor, counting_receiver>;
+  using run_loop_operation = execution::connect_result_t<run_loop::sender_type, counting_receiver>;
+
+  std::printf("%-72s %12zu bytes\n", "sizeof(error_type)", sizeof(execution::error_type));
+  std::printf("%-72s %12zu bytes\n", "sizeof(connect(ex, r)) [adapted]", sizeof(adapted_operation));
+  std::printf("%-72s %12zu bytes\n", "sizeof(submit(ex, r) state) [adapted]", sizeof(submitted_operation));
+  std::printf("%-72s %12zu bytes\n\n", "sizeof(connect(schedule(sched), r)) [run_loop]", sizeof(run_loop_operation));
+
+  measure_connect("connect(schedule(ex), r) + start [adapted, may throw]", opaque_executor{ctx.executor()});
+  measure_connect("connect(schedule(ex), r) + start [inline, may throw]", ctx.executor());
+
+  constexpr std::size_t n = 1'000'000;
+
+  {
+    std::size_t count = 0;
+
+    benchmark::measure("submit(ex, r) [adapted, may throw]", n, [&]
+    {
+      for(std::size_t i = 0; i < n; ++i)
+      {
+        execution::submit(opaque_executor{ctx.executor()}, counting_receiver{&count});
+      }
+    });
+
+    benchmark::do_not_optimize(count);
+  }
+
+  {
+    std::size_t count = 0;
+
+    benchmark::measure("execute(sched, f) + run [run_loop]", n, [&]
+    {
+      run_loop loop;
+
+      for(std::size_t i = 0; i < n; ++i)
+      {
+        execution::execute(loop.scheduler(), [&count]{ ++count; });
+      }
+
+      loop.finish();
+      loop.run();
+    });
+
+    benchmark::do_not_optimize(count);
+  }
+
+  {
+    std::size_t count = 0;
+
+    benchmark::measure("set_error(r, make_error())", n, [&]
+    {
+      for(std::size_t i = 0; i < n; ++i)
+      {
+        execution::set_error(counting_receiver{&count}, make_error());
+      }
+    });
+
+    benchmark::do_not_optimize(count);
+  }
+
+  return 0;
+}
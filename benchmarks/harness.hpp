@@ -0,0 +1,81 @@
+#pragma once
+
+// a minimal, self-contained benchmark harness
+//
+// including this header replaces the global allocation functions so that every benchmark
+// can report allocations/op alongside ns/op, so it must be included by exactly one
+// translation unit per benchmark program
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+
+namespace benchmark
+{
+
+
+inline std::atomic<std::size_t> num_allocations{0};
+
+
+// prevents the optimizer from discarding a value or the computation producing it
+template<class T>
+inline void do_not_optimize(T&& value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+
+// runs f(), which should perform num_ops operations, once to warm up and then again while measuring
+template<class F>
+void measure(const char* name, std::size_t num_ops, F&& f)
+{
+  f();
+
+  std::size_t allocations_before = num_allocations.load(std::memory_order_relaxed);
+  auto before = std::chrono::steady_clock::now();
+
+  f();
+
+  auto after = std::chrono::steady_clock::now();
+  std::size_t allocations = num_allocations.load(std::memory_order_relaxed) - allocations_before;
+
+  double ns = std::chrono::duration<double, std::nano>(after - before).count();
+
+  std::printf("%-72s %12.2f ns/op %10.3f allocs/op\n", name, ns / num_ops, double(allocations) / num_ops);
+}
+
+
+} // end benchmark
+
+
+// these are kept out of line so that their use of malloc and free is not mistaken for mismatched new/delete
+[[gnu::noinline]] void* operator new(std::size_t n)
+{
+  benchmark::num_allocations.fetch_add(1, std::memory_order_relaxed);
+
+  if(void* result = std::malloc(n ? n : 1))
+  {
+    return result;
+  }
+
+#if defined(__cpp_exceptions)
+  throw std::bad_alloc();
+#else
+  std::abort();
+#endif
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
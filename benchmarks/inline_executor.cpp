@@ -0,0 +1,112 @@
+// $ clang-10 -std=c++20 -O3 -I.. inline_executor.cpp -lstdc++
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "execution_context.hpp"
+#include <cstddef>
+
+
+struct counting_receiver
+{
+  std::size_t* count_;
+
+  void set_value() && noexcept
+  {
+    ++*count_;
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+struct throwing_receiver : counting_receiver
+{
+  void set_value() &&
+  {
+    ++*count_;
+  }
+};
+
+
+// the same executor without the is_inline_executor specialization
+struct opaque_executor
+{
+  execution_context::executor_type ex_;
+
+  template<class F>
+    requires invocable<F&>
+  void execute(F&& f) const
+  {
+    ex_.execute(std::forward<F>(f));
+  }
+
+  friend bool operator==(const opaque_executor& a, const opaque_executor& b)
+  {
+    return a.ex_ == b.ex_;
+  }
+
+  friend bool operator!=(const opaque_executor& a, const opaque_executor& b)
+  {
+    return !(a == b);
+  }
+};
+
+
+using inline_operation = execution::connect_result_t<execution_context::executor_type, counting_receiver>;
+
+// the operation is nothing but the receiver and starting it cannot throw
+static_assert(sizeof(inline_operation) == sizeof(counting_receiver));
+static_assert(noexcept(execution::start(std::declval<inline_operation&>())));
+static_assert(noexcept(execution::execute(std::declval<execution_context::executor_type>(), counting_receiver{})));
+
+
+template<class Executor, class Receiver>
+void measure_connect(const char* name, Executor ex)
+{
+  constexpr std::size_t n = 100'000'000;
+  std::size_t count = 0;
+
+  benchmark::measure(name, n, [&]
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      auto op = execution::connect(execution::schedule(ex), Receiver{&count});
+      execution::start(op);
+      benchmark::do_not_optimize(op);
+    }
+  });
+
+  benchmark::do_not_optimize(count);
+}
+
+
+int main()
+{
+  execution_context ctx;
+
+  measure_connect<opaque_executor, counting_receiver>("connect(schedule(ex), r) + start [adapted, nothrow]", {ctx.executor()});
+  measure_connect<execution_context::executor_type, counting_receiver>("connect(schedule(ex), r) + start [inline, nothrow]", ctx.executor());
+  measure_connect<opaque_executor, throwing_receiver>("connect(schedule(ex), r) + start [adapted, may throw]", {ctx.executor()});
+  measure_connect<execution_context::executor_type, throwing_receiver>("connect(schedule(ex), r) + start [inline, may throw]", ctx.executor());
+
+  constexpr std::size_t n = 100'000'000;
+  std::size_t count = 0;
+
+  benchmark::measure("execute(ex, r) [inline]", n, [&]
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      counting_receiver r{&count};
+      execution::execute(ctx.executor(), std::move(r));
+      benchmark::do_not_optimize(r);
+    }
+  });
+
+  benchmark::do_not_optimize(count);
+
+  return 0;
+}
+
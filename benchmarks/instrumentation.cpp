@@ -0,0 +1,131 @@
+// $ clang-10 -std=c++20 -O3 -I.. instrumentation.cpp -lstdc++ -lpthread
+// $ clang-10 -std=c++20 -O3 -DEXECUTION_INSTRUMENTATION -I.. instrumentation.cpp -lstdc++ -lpthread
+
+// measures the overhead of instrument(ex, stats) on a run_loop driven by the thread posting to it
+//
+// built without EXECUTION_INSTRUMENTATION, the instrumented executor is the run_loop's own
+// scheduler, so its results should match the uninstrumented ones. built with it, the difference
+// is the cost of recording, and the stats recorded are printed afterward
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "instrumentation.hpp"
+#include "run_loop.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <type_traits>
+#include <utility>
+
+
+struct counting_receiver
+{
+  std::size_t* count_;
+
+  void set_value() && noexcept
+  {
+    ++*count_;
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+template<class Executor>
+void measure_execute(const char* name, run_loop& loop, const Executor& ex, std::size_t n)
+{
+  benchmark::measure(name, n, [&]
+  {
+    std::size_t count = 0;
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      execution::execute(ex, [&count]{ ++count; });
+    }
+
+    loop.finish();
+    loop.run();
+
+    benchmark::do_not_optimize(count);
+  });
+}
+
+
+template<class Executor>
+void measure_submit(const char* name, run_loop& loop, const Executor& ex, std::size_t n)
+{
+  benchmark::measure(name, n, [&]
+  {
+    std::size_t count = 0;
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      execution::submit(execution::schedule(ex), counting_receiver{&count});
+    }
+
+    loop.finish();
+    loop.run();
+
+    benchmark::do_not_optimize(count);
+  });
+}
+
+
+void print(const char* name, const histogram& h)
+{
+  std::printf("%-24s %12llu samples %10llu p50 %10llu p99 %10llu max\n", name,
+    static_cast<unsigned long long>(h.count()),
+    static_cast<unsigned long long>(h.percentile(0.5)),
+    static_cast<unsigned long long>(h.percentile(0.99)),
+    static_cast<unsigned long long>(h.max())
+  );
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 1'000'000;
+
+  executor_stats stats;
+
+  {
+    run_loop loop;
+    measure_execute("execute(sched, f)", loop, loop.scheduler(), n);
+  }
+
+  {
+    run_loop loop;
+    measure_execute("execute(instrument(sched, stats), f)", loop, instrument(loop.scheduler(), stats), n);
+  }
+
+  {
+    run_loop loop;
+    measure_submit("submit(schedule(sched), r)", loop, loop.scheduler(), n);
+  }
+
+  {
+    run_loop loop;
+    measure_submit("submit(schedule(instrument(sched, stats)), r)", loop, instrument(loop.scheduler(), stats), n);
+  }
+
+#if defined(EXECUTION_INSTRUMENTATION)
+  executor_stats::snapshot_type snapshot = stats.snapshot();
+
+  std::printf("\n");
+  print("dispatch latency (ns)", snapshot.dispatch_latency_);
+  print("run time (ns)", snapshot.run_time_);
+  print("queue depth", snapshot.queue_depth_);
+  std::printf("%-24s %12llu invocable %10llu as_invocable %10llu receiver %10llu submit_receiver\n", "enqueued",
+    static_cast<unsigned long long>(snapshot.num_enqueued_[0]),
+    static_cast<unsigned long long>(snapshot.num_enqueued_[1]),
+    static_cast<unsigned long long>(snapshot.num_enqueued_[2]),
+    static_cast<unsigned long long>(snapshot.num_enqueued_[3])
+  );
+#else
+  static_assert(std::is_same_v<decltype(instrument(std::declval<run_loop::scheduler_type>(), stats)), run_loop::scheduler_type>);
+#endif
+
+  return 0;
+}
@@ -0,0 +1,418 @@
+// $ clang-10 -std=c++20 -O3 -I.. io_uring_context.cpp -lstdc++ -lpthread
+
+// passes a byte through a pipe n times, each time writing it and then reading it back once readable
+//
+// on io_uring_context, each read and write is an operation whose completion arrives on the ring's
+// thread, which starts the next. the baseline is the epoll reactor the context replaces: a reactor
+// thread waits for the pipe to become readable and bounces each readiness event through
+// execution::execute onto a single_thread_context, which performs the read and the next write
+//
+// before measuring, checks async_read, async_write and async_accept upon a pipe, a file and a loopback
+// socket: that data round-trips, that reading at end of file sends 0, that errors arrive through
+// set_error, and that a stop request completes a pending read or accept with set_done
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "io_uring_context.hpp"
+#include "single_thread_context.hpp"
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <optional>
+#include <span>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+
+
+struct pipe_state
+{
+  int read_fd_;
+  int write_fd_;
+  std::byte byte_{};
+  std::size_t remaining_;
+  std::atomic<bool> done_{false};
+};
+
+
+struct read_receiver
+{
+  io_uring_context::executor_type ex_;
+  pipe_state* state_;
+
+  void set_value(std::size_t) && noexcept;
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+struct write_receiver
+{
+  io_uring_context::executor_type ex_;
+  pipe_state* state_;
+
+  void set_value(std::size_t) && noexcept
+  {
+    execution::submit(execution::async_read(ex_, state_->read_fd_, std::span(&state_->byte_, 1)), read_receiver{ex_, state_});
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+void read_receiver::set_value(std::size_t) && noexcept
+{
+  if(--state_->remaining_ == 0)
+  {
+    state_->done_.store(true, std::memory_order_release);
+  }
+  else
+  {
+    execution::submit(execution::async_write(ex_, state_->write_fd_, std::span<const std::byte>(&state_->byte_, 1)), write_receiver{ex_, state_});
+  }
+}
+
+
+void wait_for(const std::atomic<bool>& done)
+{
+  while(!done.load(std::memory_order_acquire))
+  {
+    std::this_thread::yield();
+  }
+}
+
+
+// how an I/O operation completed
+struct outcome
+{
+  enum kind_type { value, error, done };
+
+  kind_type kind_;
+  std::int64_t value_;
+  int errno_;
+
+  bool is_value(std::int64_t v) const noexcept
+  {
+    return kind_ == value and value_ == v;
+  }
+
+  bool is_error(int e) const noexcept
+  {
+    return kind_ == error and errno_ == e;
+  }
+};
+
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+int error_value(std::error_code e)
+{
+  return e.value();
+}
+#else
+int error_value(std::exception_ptr e)
+{
+  try
+  {
+    std::rethrow_exception(e);
+  }
+  catch(const std::system_error& s)
+  {
+    return s.code().value();
+  }
+  catch(...)
+  {
+    return -1;
+  }
+}
+#endif
+
+
+struct outcome_receiver
+{
+  outcome* result_;
+  std::atomic<bool>* ready_;
+  execution::in_place_stop_token token_;
+
+  template<class T>
+  void set_value(T v) && noexcept
+  {
+    *result_ = {outcome::value, static_cast<std::int64_t>(v), 0};
+    ready_->store(true, std::memory_order_release);
+  }
+
+  void set_error(execution::error_type e) && noexcept
+  {
+    *result_ = {outcome::error, 0, error_value(e)};
+    ready_->store(true, std::memory_order_release);
+  }
+
+  void set_done() && noexcept
+  {
+    *result_ = {outcome::done, 0, 0};
+    ready_->store(true, std::memory_order_release);
+  }
+
+  execution::in_place_stop_token get_stop_token() const noexcept
+  {
+    return token_;
+  }
+};
+
+
+// starts s, requests its stop stop_after later if given, and waits for it to complete
+template<class S>
+outcome complete(S s, std::optional<std::chrono::milliseconds> stop_after = std::nullopt)
+{
+  execution::in_place_stop_source stop;
+  outcome result{};
+  std::atomic<bool> ready{false};
+
+  auto op = execution::connect(std::move(s), outcome_receiver{&result, &ready, stop.get_token()});
+  execution::start(op);
+
+  if(stop_after)
+  {
+    std::this_thread::sleep_for(*stop_after);
+    stop.request_stop();
+  }
+
+  wait_for(ready);
+  return result;
+}
+
+
+bool check(bool passed, const char* what)
+{
+  if(!passed)
+  {
+    std::fprintf(stderr, "check failed: %s\n", what);
+  }
+
+  return passed;
+}
+
+
+// returns whether every check passed
+bool check_io(io_uring_context::executor_type ex)
+{
+  using namespace std::chrono_literals;
+
+  bool passed = true;
+
+  const char message[] = "hello";
+  char buffer[sizeof(message)];
+
+  auto message_bytes = std::as_bytes(std::span(message));
+  auto buffer_bytes = std::as_writable_bytes(std::span(buffer));
+
+  auto round_trips = [&](const outcome& read)
+  {
+    return read.is_value(sizeof(message)) and std::memcmp(buffer, message, sizeof(message)) == 0;
+  };
+
+  {
+    int fds[2];
+
+    if(::pipe(fds) != 0)
+    {
+      return check(false, "pipe: create");
+    }
+
+    passed &= check(complete(ex.async_write(fds[1], message_bytes)).is_value(sizeof(message)), "pipe: write");
+    passed &= check(round_trips(complete(ex.async_read(fds[0], buffer_bytes))), "pipe: read what was written");
+    passed &= check(complete(ex.async_read(fds[0], buffer_bytes), 0ms).kind_ == outcome::done, "pipe: stop a read as soon as it starts");
+    passed &= check(complete(ex.async_read(fds[0], buffer_bytes), 20ms).kind_ == outcome::done, "pipe: stop a pending read");
+    passed &= check(complete(ex.async_write(fds[0], message_bytes)).is_error(EBADF), "pipe: writing the read end fails with EBADF");
+
+    ::close(fds[1]);
+    passed &= check(complete(ex.async_read(fds[0], buffer_bytes)).is_value(0), "pipe: read at end of file");
+    ::close(fds[0]);
+  }
+
+  {
+    char path[] = "/tmp/io_uring_context_XXXXXX";
+    int fd = ::mkstemp(path);
+    int read_only_fd = fd < 0 ? -1 : ::open(path, O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0 or read_only_fd < 0)
+    {
+      return check(false, "file: create");
+    }
+
+    ::unlink(path);
+
+    passed &= check(complete(ex.async_write(fd, message_bytes, 0)).is_value(sizeof(message)), "file: write at an offset");
+    passed &= check(round_trips(complete(ex.async_read(read_only_fd, buffer_bytes, 0))), "file: read what was written");
+    passed &= check(complete(ex.async_read(fd, buffer_bytes, sizeof(message))).is_value(0), "file: read at end of file");
+    passed &= check(complete(ex.async_write(read_only_fd, message_bytes, 0)).is_error(EBADF), "file: writing a read-only file fails with EBADF");
+
+    ::close(read_only_fd);
+    ::close(fd);
+  }
+
+  {
+    int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int client = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int unbound = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+
+    if(listener < 0 or client < 0 or unbound < 0 or
+       ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 or
+       ::listen(listener, 1) != 0 or
+       ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+    {
+      return check(false, "socket: listen on loopback");
+    }
+
+    passed &= check(complete(ex.async_accept(listener), 20ms).kind_ == outcome::done, "socket: stop a pending accept");
+    passed &= check(complete(ex.async_accept(unbound)).is_error(EINVAL), "socket: accepting upon a socket which is not listening fails with EINVAL");
+
+    if(::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+      return check(false, "socket: connect");
+    }
+
+    outcome accepted = complete(ex.async_accept(listener));
+    passed &= check(accepted.kind_ == outcome::value and accepted.value_ >= 0, "socket: accept");
+
+    if(accepted.kind_ == outcome::value)
+    {
+      int server = static_cast<int>(accepted.value_);
+
+      passed &= check(complete(ex.async_write(client, message_bytes)).is_value(sizeof(message)), "socket: write");
+      passed &= check(round_trips(complete(ex.async_read(server, buffer_bytes))), "socket: read what was written");
+      passed &= check(complete(ex.async_read(server, buffer_bytes), 20ms).kind_ == outcome::done, "socket: stop a pending read");
+
+      ::shutdown(client, SHUT_WR);
+      passed &= check(complete(ex.async_read(server, buffer_bytes)).is_value(0), "socket: read after the peer shuts down");
+      ::close(server);
+    }
+
+    ::close(unbound);
+    ::close(client);
+    ::close(listener);
+  }
+
+  return passed;
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 100'000;
+
+  int fds[2];
+
+  if(::pipe(fds) != 0)
+  {
+    return 1;
+  }
+
+  {
+    io_uring_context ctx;
+    auto ex = ctx.executor();
+
+    if(!check_io(ex))
+    {
+      return 1;
+    }
+
+    benchmark::measure("async_write + async_read [io_uring_context]", n, [&]
+    {
+      pipe_state state{fds[0], fds[1], std::byte{}, n};
+
+      // start on the ring's thread, so that every operation is prepared there
+      execution::execute(ex, [&]
+      {
+        execution::submit(execution::async_write(ex, state.write_fd_, std::span<const std::byte>(&state.byte_, 1)), write_receiver{ex, &state});
+      });
+
+      wait_for(state.done_);
+    });
+  }
+
+  {
+    single_thread_context ctx;
+    auto ex = ctx.executor();
+
+    int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    epoll_event interest{};
+    interest.events = EPOLLIN | EPOLLONESHOT;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fds[0], &interest);
+
+    std::atomic<pipe_state*> current{nullptr};
+    std::atomic<bool> stopping{false};
+
+    auto on_readable = [&]
+    {
+      pipe_state& state = *current.load(std::memory_order_acquire);
+
+      [[maybe_unused]] auto result = ::read(state.read_fd_, &state.byte_, 1);
+
+      if(--state.remaining_ == 0)
+      {
+        state.done_.store(true, std::memory_order_release);
+      }
+      else
+      {
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, state.read_fd_, &interest);
+        result = ::write(state.write_fd_, &state.byte_, 1);
+      }
+    };
+
+    // a separate epoll thread, which hands each readiness event to ex
+    std::thread reactor([&]
+    {
+      while(!stopping.load(std::memory_order_acquire))
+      {
+        epoll_event event;
+
+        if(::epoll_wait(epoll_fd, &event, 1, 10) == 1)
+        {
+          execution::execute(ex, on_readable);
+        }
+      }
+    });
+
+    benchmark::measure("write + epoll_wait + execute + read [epoll reactor]", n, [&]
+    {
+      pipe_state state{fds[0], fds[1], std::byte{}, n};
+      current.store(&state, std::memory_order_release);
+
+      ::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, state.read_fd_, &interest);
+      [[maybe_unused]] auto result = ::write(state.write_fd_, &state.byte_, 1);
+
+      wait_for(state.done_);
+    });
+
+    stopping = true;
+    reactor.join();
+    ::close(epoll_fd);
+  }
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+
+  return 0;
+}
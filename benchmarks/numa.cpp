@@ -0,0 +1,111 @@
+// $ clang-10 -std=c++20 -O3 -I.. numa.cpp -lstdc++ -lpthread
+
+// runs a memory-bound workload through execution::execute on a thread_pool pinned to the machine's topology
+//
+// each node owns an array first touched by that node's workers. every task sums one chunk of an array,
+// either through an executor narrowed to the array's node or through one which may run anywhere
+// on a single-node machine both paths should perform alike
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "thread_pool.hpp"
+#include "topology.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+constexpr std::size_t chunk_size = 64 * 1024 / sizeof(std::uint64_t);
+constexpr std::size_t chunks_per_node = 1024;
+
+
+void wait_for(const std::atomic<std::size_t>& count, std::size_t n)
+{
+  while(count.load(std::memory_order_acquire) != n)
+  {
+    std::this_thread::yield();
+  }
+}
+
+
+int main()
+{
+  topology t = topology::system();
+  thread_pool pool(t);
+
+  std::printf("%zu nodes, %zu workers\n", pool.num_nodes(), pool.num_threads());
+
+  // default-initialized, so that no page is touched before a node's workers touch it
+  std::vector<std::unique_ptr<std::uint64_t[]>> arrays;
+
+  for(std::size_t node = 0; node < pool.num_nodes(); ++node)
+  {
+    arrays.emplace_back(new std::uint64_t[chunks_per_node * chunk_size]);
+  }
+
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t node = 0; node < pool.num_nodes(); ++node)
+    {
+      for(std::size_t c = 0; c < chunks_per_node; ++c)
+      {
+        execution::execute(pool.executor(node), [&, chunk = arrays[node].get() + c * chunk_size]
+        {
+          for(std::size_t i = 0; i < chunk_size; ++i)
+          {
+            chunk[i] = i;
+          }
+
+          count.fetch_add(1, std::memory_order_release);
+        });
+      }
+    }
+
+    wait_for(count, pool.num_nodes() * chunks_per_node);
+  }
+
+  std::size_t n = pool.num_nodes() * chunks_per_node;
+
+  auto sum_chunks = [&](auto executor_for_node)
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t c = 0; c < chunks_per_node; ++c)
+    {
+      for(std::size_t node = 0; node < pool.num_nodes(); ++node)
+      {
+        execution::execute(executor_for_node(node), [&, chunk = arrays[node].get() + c * chunk_size]
+        {
+          std::uint64_t sum = 0;
+
+          for(std::size_t i = 0; i < chunk_size; ++i)
+          {
+            sum += chunk[i];
+          }
+
+          benchmark::do_not_optimize(sum);
+          count.fetch_add(1, std::memory_order_release);
+        });
+      }
+    }
+
+    wait_for(count, n);
+  };
+
+  benchmark::measure("execute(pool.executor(node), sum chunk) [hinted]", n, [&]
+  {
+    sum_chunks([&](std::size_t node){ return pool.executor(node); });
+  });
+
+  benchmark::measure("execute(pool.executor(), sum chunk) [unhinted]", n, [&]
+  {
+    sum_chunks([&](std::size_t){ return pool.executor(); });
+  });
+
+  return 0;
+}
@@ -0,0 +1,175 @@
+// $ clang-10 -std=c++20 -O3 -I.. outside_submission.cpp -lstdc++ -lpthread
+// $ ./a.out [num_threads] [tasks_per_thread] [window]
+
+// measures the throughput of threads outside a thread_pool executing work upon it concurrently, by
+// default 32 threads each executing 10M tasks, and the cache misses incurred per task
+//
+// executing upon pool.executor() enqueues upon the injection queue each outside thread's thread_local
+// slot selects, so threads submitting concurrently contend on distinct locks rather than all on one.
+// as a baseline, executing upon pool.executor(0) funnels every outside thread through the single
+// injection queue of the pool's only node
+//
+// each thread keeps at most window tasks, by default 4096, outstanding at a time, so that producers
+// which outpace the pool wait for it rather than exhausting memory. cache misses are counted with
+// perf_event_open, and are reported as n/a where hardware counters are unavailable
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+
+// counts the cache misses of the calling thread and of the threads it creates after the counter
+// the counts of those threads are accumulated only as they exit, so read the counter after joining them
+class cache_miss_counter
+{
+  public:
+    cache_miss_counter() noexcept
+    {
+      perf_event_attr attr{};
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = PERF_COUNT_HW_CACHE_MISSES;
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+
+      fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    cache_miss_counter(const cache_miss_counter&) = delete;
+
+    ~cache_miss_counter()
+    {
+      if(valid())
+      {
+        close(fd_);
+      }
+    }
+
+    bool valid() const noexcept
+    {
+      return fd_ >= 0;
+    }
+
+    std::uint64_t read() const noexcept
+    {
+      std::uint64_t result = 0;
+
+      if(valid() and ::read(fd_, &result, sizeof(result)) != sizeof(result))
+      {
+        result = 0;
+      }
+
+      return result;
+    }
+
+  private:
+    int fd_;
+};
+
+
+// counts the tasks an outside thread has executed which have yet to run
+struct alignas(64) outstanding_tasks
+{
+  std::atomic<std::size_t> count_{0};
+};
+
+
+// node is thread_pool::any_node to measure per-thread injection queues, or 0 to measure the single shared queue
+void measure_outside_submission(std::size_t num_threads, std::size_t tasks_per_thread, std::size_t window, std::size_t node, const cache_miss_counter& counter)
+{
+  std::size_t num_tasks = num_threads * tasks_per_thread;
+  std::uint64_t misses = 0;
+
+  char name[128];
+  std::snprintf(name, sizeof(name), "execute(ex, f) from %zu outside threads [%s]",
+    num_threads,
+    node == thread_pool::any_node ? "per-thread injection queues" : "single injection queue"
+  );
+
+  benchmark::measure(name, num_tasks, [&]
+  {
+    std::uint64_t before = counter.read();
+
+    {
+      // outstanding outlives the pool, whose destructor runs the tasks which refer to it
+      std::vector<outstanding_tasks> outstanding(num_threads);
+
+      // the pool's workers are created within the measurement so that their misses are counted
+      thread_pool pool;
+      std::vector<std::thread> threads;
+
+      for(std::size_t i = 0; i < num_threads; ++i)
+      {
+        threads.emplace_back([ex = pool.executor(node), tasks_per_thread, window, &outstanding = outstanding[i].count_]
+        {
+          for(std::size_t j = 0; j < tasks_per_thread; ++j)
+          {
+            while(outstanding.load(std::memory_order_acquire) >= window)
+            {
+              std::this_thread::yield();
+            }
+
+            outstanding.fetch_add(1, std::memory_order_relaxed);
+
+            execution::execute(ex, [j, &outstanding]
+            {
+              benchmark::do_not_optimize(j);
+              outstanding.fetch_sub(1, std::memory_order_release);
+            });
+          }
+        });
+      }
+
+      for(std::thread& t : threads)
+      {
+        t.join();
+      }
+
+      // the pool completes outstanding work before its destructor returns
+    }
+
+    misses = counter.read() - before;
+  });
+
+  if(counter.valid())
+  {
+    std::printf("%-72s %12.2f misses/op\n", "", double(misses) / num_tasks);
+  }
+  else
+  {
+    std::printf("%-72s %12s misses/op\n", "", "n/a");
+  }
+}
+
+
+int main(int argc, char** argv)
+{
+  std::size_t num_threads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 32;
+  std::size_t tasks_per_thread = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10'000'000;
+  std::size_t window = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 4096;
+
+  num_threads = std::max<std::size_t>(num_threads, 1);
+  window = std::max<std::size_t>(window, 1);
+
+  cache_miss_counter counter;
+
+  for(std::size_t node : {thread_pool::any_node, std::size_t(0)})
+  {
+    measure_outside_submission(1, tasks_per_thread, window, node, counter);
+    measure_outside_submission(num_threads, tasks_per_thread, window, node, counter);
+  }
+
+  return 0;
+}
@@ -0,0 +1,148 @@
+// $ clang-10 -std=c++20 -O3 -march=native -I.. parallel_algorithms.cpp -lstdc++ -lpthread -ltbb
+// $ ./a.out [max_n]
+
+// compares the parallel algorithms run upon a thread_pool executor with sequential loops and with
+// the std parallel algorithms run with std::execution::par, over 10^6 elements up to max_n, by
+// default 10^8. a max_n of 10^9 requires roughly 16 GB of memory
+//
+// libstdc++ implements std::execution::par with TBB, so link with -ltbb
+
+#include "harness.hpp"
+#include "parallel_algorithms.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <execution>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+
+void measure_algorithms(thread_pool::executor_type ex, std::size_t n)
+{
+  std::vector<float> x(n, 1.f);
+  std::vector<float> y(n, 2.f);
+
+  char name[128];
+
+  auto measure = [&](const char* algorithm, const char* variant, auto f)
+  {
+    std::snprintf(name, sizeof(name), "%s [%s, n=%zu]", algorithm, variant, n);
+    benchmark::measure(name, n, f);
+  };
+
+  auto axpy = [](float& e){ e = 2.f * e + 1.f; };
+
+  measure("for_each", "sequential", [&]
+  {
+    for(float& e : x)
+    {
+      axpy(e);
+    }
+  });
+
+  measure("for_each", "std::execution::par", [&]
+  {
+    std::for_each(std::execution::par, x.begin(), x.end(), axpy);
+  });
+
+  measure("for_each", "thread_pool", [&]
+  {
+    execution::for_each(ex, x.begin(), x.end(), axpy);
+  });
+
+  auto square = [](float e){ return e * e; };
+
+  measure("transform", "sequential", [&]
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      y[i] = square(x[i]);
+    }
+  });
+
+  measure("transform", "std::execution::par", [&]
+  {
+    std::transform(std::execution::par, x.begin(), x.end(), y.begin(), square);
+  });
+
+  measure("transform", "thread_pool", [&]
+  {
+    execution::transform(ex, x.begin(), x.end(), y.begin(), square);
+  });
+
+  // the inner product, accumulated in double so that sums of many floats stay exact enough to compare
+  auto product = [](float a, float b){ return double(a) * b; };
+  double result = 0;
+
+  measure("transform_reduce", "sequential", [&]
+  {
+    result = 0;
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      result += product(x[i], y[i]);
+    }
+  });
+
+  benchmark::do_not_optimize(result);
+
+  measure("transform_reduce", "std::execution::par", [&]
+  {
+    result = std::transform_reduce(std::execution::par, x.begin(), x.end(), y.begin(), 0., std::plus<>{}, product);
+  });
+
+  benchmark::do_not_optimize(result);
+
+  measure("transform_reduce", "thread_pool", [&]
+  {
+    result = execution::transform_reduce(ex, x.begin(), x.end(), y.begin(), 0., std::plus<>{}, product);
+  });
+
+  benchmark::do_not_optimize(result);
+
+  std::vector<int> a(n, 1);
+  std::vector<int> b(n);
+
+  measure("inclusive_scan", "sequential", [&]
+  {
+    int sum = 0;
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      sum += a[i];
+      b[i] = sum;
+    }
+  });
+
+  measure("inclusive_scan", "std::execution::par", [&]
+  {
+    std::inclusive_scan(std::execution::par, a.begin(), a.end(), b.begin());
+  });
+
+  measure("inclusive_scan", "thread_pool", [&]
+  {
+    execution::inclusive_scan(ex, a.begin(), a.end(), b.begin());
+  });
+
+  benchmark::do_not_optimize(b.data());
+
+  std::printf("\n");
+}
+
+
+int main(int argc, char** argv)
+{
+  std::size_t max_n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000'000;
+
+  thread_pool pool;
+
+  for(std::size_t n = 1'000'000; n <= max_n; n *= 10)
+  {
+    measure_algorithms(pool.executor(), n);
+  }
+
+  return 0;
+}
@@ -0,0 +1,121 @@
+// $ clang-10 -std=c++20 -O3 -I.. priority_context.cpp -lstdc++ -lpthread
+
+// measures the dispatch latency of urgent work on a priority_context saturated by background work
+//
+// background tasks keep the context busy by re-executing themselves, so that the background queue is
+// never empty. each sample executes one task and records the time from execute to the task starting,
+// once through an executor with_priority high and once at background priority, where it queues behind
+// the saturating tasks as it would on a FIFO context
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "priority_context.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+using clock_type = std::chrono::steady_clock;
+
+
+// burns roughly a microsecond
+void background_work()
+{
+  auto end = clock_type::now() + std::chrono::microseconds(1);
+
+  while(clock_type::now() < end)
+  {
+  }
+}
+
+
+template<class Executor>
+struct background_task
+{
+  Executor ex_;
+  const std::atomic<bool>* running_;
+  std::atomic<std::size_t>* num_outstanding_;
+
+  void operator()() const
+  {
+    background_work();
+
+    if(running_->load(std::memory_order_relaxed))
+    {
+      execution::execute(ex_, *this);
+    }
+    else
+    {
+      num_outstanding_->fetch_sub(1, std::memory_order_release);
+    }
+  }
+};
+
+
+template<class Executor>
+void measure_latency(const char* name, priority_context& ctx, Executor ex, std::size_t num_samples)
+{
+  constexpr std::size_t num_background_tasks = 64;
+
+  std::atomic<bool> running{true};
+  std::atomic<std::size_t> num_outstanding{num_background_tasks};
+
+  auto background = execution::with_priority(ctx.executor(), priority_context::priority::background);
+
+  for(std::size_t i = 0; i < num_background_tasks; ++i)
+  {
+    execution::execute(background, background_task<decltype(background)>{background, &running, &num_outstanding});
+  }
+
+  std::vector<double> latencies(num_samples);
+
+  for(std::size_t i = 0; i < num_samples; ++i)
+  {
+    std::atomic<bool> done{false};
+    auto before = clock_type::now();
+
+    execution::execute(ex, [&, i]
+    {
+      latencies[i] = std::chrono::duration<double, std::nano>(clock_type::now() - before).count();
+      done.store(true, std::memory_order_release);
+    });
+
+    while(!done.load(std::memory_order_acquire))
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  running = false;
+
+  while(num_outstanding.load(std::memory_order_acquire) != 0)
+  {
+    std::this_thread::yield();
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+
+  std::printf("%-72s %12.2f ns p50 %12.2f ns p99\n", name, latencies[num_samples / 2], latencies[num_samples * 99 / 100]);
+}
+
+
+int main()
+{
+  constexpr std::size_t num_samples = 1'000;
+
+  priority_context ctx;
+
+  measure_latency("execute(with_priority(ex, high), f) under saturation", ctx,
+    execution::with_priority(ctx.executor(), priority_context::priority::high), num_samples
+  );
+
+  measure_latency("execute(with_priority(ex, background), f) under saturation", ctx,
+    execution::with_priority(ctx.executor(), priority_context::priority::background), num_samples
+  );
+
+  return 0;
+}
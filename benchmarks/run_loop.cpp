@@ -0,0 +1,124 @@
+// $ clang-10 -std=c++20 -O3 -I.. run_loop.cpp -lstdc++ -lpthread
+
+// compares the cost of posting to a run_loop from the thread running it, which links into the
+// loop's non-atomic local queue, against posting from another thread through its lock-free queue
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "run_loop.hpp"
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+
+struct counting_receiver
+{
+  std::size_t* count_;
+
+  void set_value() && noexcept
+  {
+    ++*count_;
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+int main()
+{
+  constexpr std::size_t n = 1'000'000;
+
+  using operation_type = execution::connect_result_t<run_loop::sender_type, counting_receiver>;
+  std::allocator<operation_type> alloc;
+  operation_type* operations = alloc.allocate(n);
+
+  auto post_all = [&](run_loop& loop, std::size_t& count)
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      operation_type* op = ::new(static_cast<void*>(operations + i)) operation_type(
+        execution::connect(execution::schedule(loop.scheduler()), counting_receiver{&count})
+      );
+
+      execution::start(*op);
+    }
+
+    loop.finish();
+  };
+
+  benchmark::measure("connect(schedule(sched), r) + start [same thread]", n, [&]
+  {
+    run_loop loop;
+    std::size_t count = 0;
+
+    execution::execute(loop.scheduler(), [&]
+    {
+      post_all(loop, count);
+    });
+
+    loop.run();
+
+    benchmark::do_not_optimize(count);
+    std::destroy_n(operations, n);
+  });
+
+  benchmark::measure("connect(schedule(sched), r) + start [cross thread]", n, [&]
+  {
+    run_loop loop;
+    std::size_t count = 0;
+
+    std::thread loop_thread([&]{ loop.run(); });
+
+    post_all(loop, count);
+
+    loop_thread.join();
+
+    benchmark::do_not_optimize(count);
+    std::destroy_n(operations, n);
+  });
+
+  alloc.deallocate(operations, n);
+
+  benchmark::measure("execute(sched, f) [same thread]", n, [&]
+  {
+    run_loop loop;
+    std::size_t count = 0;
+
+    execution::execute(loop.scheduler(), [&]
+    {
+      for(std::size_t i = 0; i < n; ++i)
+      {
+        execution::execute(loop.scheduler(), [&count]{ ++count; });
+      }
+
+      loop.finish();
+    });
+
+    loop.run();
+
+    benchmark::do_not_optimize(count);
+  });
+
+  benchmark::measure("execute(sched, f) [cross thread]", n, [&]
+  {
+    run_loop loop;
+    std::size_t count = 0;
+
+    std::thread loop_thread([&]{ loop.run(); });
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      execution::execute(loop.scheduler(), [&count]{ ++count; });
+    }
+
+    loop.finish();
+    loop_thread.join();
+
+    benchmark::do_not_optimize(count);
+  });
+
+  return 0;
+}
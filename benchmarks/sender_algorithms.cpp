@@ -0,0 +1,258 @@
+// $ clang-10 -std=c++20 -O3 -I.. sender_algorithms.cpp -lstdc++ -lpthread
+
+// compares a 5-stage pipeline composed with then, whose operation state is a single object
+// started once, against the same pipeline chained by hand through execution::submit
+//
+// before measuring, checks that a stop request forwarded to when_all, whose children all complete
+// within it, does not touch the operation after its receiver has destroyed it
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "execution_context.hpp"
+#include "sender_algorithms.hpp"
+#include "single_thread_context.hpp"
+#include "thread_pool.hpp"
+#include "timer_context.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+
+
+struct counting_receiver
+{
+  std::atomic<std::size_t>* count_;
+
+  void set_value(int) && noexcept
+  {
+    count_->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+int stage(int x) noexcept
+{
+  return x + 1;
+}
+
+
+// each stage of the hand-written chain submits the next onto the same executor
+template<class Executor, int N>
+struct submit_chain_receiver
+{
+  Executor ex_;
+  std::atomic<std::size_t>* count_;
+  int value_;
+
+  void set_value() && noexcept
+  {
+    int value = stage(value_);
+
+    if constexpr(N == 1)
+    {
+      benchmark::do_not_optimize(value);
+      count_->fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+      execution::submit(execution::schedule(ex_), submit_chain_receiver<Executor,N-1>{ex_, count_, value});
+    }
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+template<class Executor>
+auto then_pipeline(Executor ex)
+{
+  return execution::then(
+    execution::then(
+      execution::then(
+        execution::then(
+          execution::then(execution::schedule(ex), []{ return stage(0); }),
+          stage
+        ),
+        stage
+      ),
+      stage
+    ),
+    stage
+  );
+}
+
+
+void wait_for(const std::atomic<std::size_t>& count, std::size_t n)
+{
+  while(count.load(std::memory_order_relaxed) != n)
+  {
+    std::this_thread::yield();
+  }
+}
+
+
+// destroys the operation it belongs to as it completes
+struct destroying_receiver
+{
+  void* op_;
+  void (*destroy_)(void*);
+  std::atomic<bool>* done_;
+  execution::in_place_stop_token token_;
+
+  void set_value() && noexcept
+  {
+    complete(false);
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept
+  {
+    complete(false);
+  }
+
+  void set_done() && noexcept
+  {
+    complete(true);
+  }
+
+  execution::in_place_stop_token get_stop_token() const noexcept
+  {
+    return token_;
+  }
+
+  void complete(bool done) noexcept
+  {
+    // destroying the operation destroys this receiver
+    std::atomic<bool>* result = done_;
+    destroy_(op_);
+    result->store(done, std::memory_order_release);
+  }
+};
+
+
+// returns whether when_all completed with set_done when its children complete within the stop callback
+// which cancels them, and whose receiver destroys the operation
+bool check_when_all_stop()
+{
+  timer_context timers;
+  auto sched = timers.scheduler();
+
+  auto sender = execution::when_all(
+    execution::schedule_after(sched, std::chrono::hours(1)),
+    execution::schedule_after(sched, std::chrono::hours(1))
+  );
+
+  using operation_type = execution::connect_result_t<decltype(sender), destroying_receiver>;
+
+  execution::in_place_stop_source stop;
+  std::atomic<bool> done{false};
+
+  void* storage = ::operator new(sizeof(operation_type));
+  auto destroy = [](void* op)
+  {
+    static_cast<operation_type*>(op)->~operation_type();
+    ::operator delete(op);
+  };
+
+  auto* op = ::new(storage) operation_type(
+    execution::connect(std::move(sender), destroying_receiver{storage, destroy, &done, stop.get_token()})
+  );
+
+  execution::start(*op);
+  stop.request_stop();
+
+  if(!done.load(std::memory_order_acquire))
+  {
+    std::fprintf(stderr, "check failed: when_all did not complete with set_done upon a forwarded stop request\n");
+    return false;
+  }
+
+  return true;
+}
+
+
+template<class Executor>
+void measure_executor(const std::string& executor_name, Executor ex, std::size_t n)
+{
+  auto name = [&](const char* path)
+  {
+    return executor_name + ": " + path;
+  };
+
+  using operation_type = execution::connect_result_t<decltype(then_pipeline(ex)), counting_receiver>;
+
+  std::allocator<operation_type> alloc;
+  operation_type* operations = alloc.allocate(n);
+
+  benchmark::measure(name("5 x then, connect + start").c_str(), n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      operation_type* op = ::new(static_cast<void*>(operations + i)) operation_type(
+        execution::connect(then_pipeline(ex), counting_receiver{&count})
+      );
+
+      execution::start(*op);
+    }
+
+    wait_for(count, n);
+
+    std::destroy_n(operations, n);
+  });
+
+  alloc.deallocate(operations, n);
+
+  benchmark::measure(name("5 x submit, chained by hand").c_str(), n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      execution::submit(execution::schedule(ex), submit_chain_receiver<Executor,5>{ex, &count, -1});
+    }
+
+    wait_for(count, n);
+  });
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 1'000'000;
+
+  if(!check_when_all_stop())
+  {
+    return 1;
+  }
+
+  {
+    execution_context ctx;
+    measure_executor("inline", ctx.executor(), n);
+  }
+
+  {
+    single_thread_context ctx;
+    measure_executor("single_thread_context", ctx.executor(), n);
+  }
+
+  {
+    thread_pool pool;
+    measure_executor("thread_pool", pool.executor(), n);
+  }
+
+  return 0;
+}
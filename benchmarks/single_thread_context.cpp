@@ -0,0 +1,85 @@
+// $ clang-10 -std=c++20 -O3 -I.. single_thread_context.cpp -lstdc++ -lpthread
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "single_thread_context.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+
+struct counting_receiver
+{
+  std::atomic<std::size_t>* count_;
+
+  void set_value() && noexcept
+  {
+    count_->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+void wait_for(const std::atomic<std::size_t>& count, std::size_t n)
+{
+  while(count.load(std::memory_order_relaxed) != n)
+  {
+    std::this_thread::yield();
+  }
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 1'000'000;
+
+  single_thread_context ctx;
+  auto ex = ctx.executor();
+
+  benchmark::measure("execute(ex, f) [invocable_task]", n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      execution::execute(ex, [&count]
+      {
+        count.fetch_add(1, std::memory_order_relaxed);
+      });
+    }
+
+    wait_for(count, n);
+  });
+
+  using operation_type = execution::connect_result_t<single_thread_context::sender_type, counting_receiver>;
+  std::allocator<operation_type> alloc;
+  operation_type* operations = alloc.allocate(n);
+
+  benchmark::measure("connect(schedule(ex), r) + start [intrusive]", n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      operation_type* op = ::new(static_cast<void*>(operations + i)) operation_type(
+        execution::connect(execution::schedule(ex), counting_receiver{&count})
+      );
+
+      execution::start(*op);
+    }
+
+    wait_for(count, n);
+
+    std::destroy_n(operations, n);
+  });
+
+  alloc.deallocate(operations, n);
+
+  return 0;
+}
+
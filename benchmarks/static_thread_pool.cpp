@@ -0,0 +1,132 @@
+// $ clang-10 -std=c++20 -O3 -I.. static_thread_pool.cpp -lstdc++ -lpthread
+// $ ./a.out [num_producers] [tasks_per_producer]
+
+// measures the throughput and latency of static_thread_pool across queue capacities and overflow
+// policies, with the unbounded thread_pool as a baseline, by default with 4 producers each executing
+// 1M tasks
+//
+// each task records the time from its submission until it runs. the latency percentiles are those
+// of the tasks which ran: under the reject policy, the rest were rejected because the queue was full
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "static_thread_pool.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::uint64_t not_run = std::numeric_limits<std::uint64_t>::max();
+
+
+struct latency_task
+{
+  clock_type::time_point submitted_;
+  std::uint64_t* latency_;
+
+  void operator()() const
+  {
+    *latency_ = static_cast<std::uint64_t>(std::chrono::nanoseconds(clock_type::now() - submitted_).count());
+  }
+};
+
+
+template<class Pool, class... Args>
+void measure_latency(const char* name, std::size_t num_producers, std::size_t tasks_per_producer, Args... args)
+{
+  std::size_t num_tasks = num_producers * tasks_per_producer;
+  std::vector<std::uint64_t> latencies(num_tasks);
+
+  benchmark::measure(name, num_tasks, [&]
+  {
+    std::fill(latencies.begin(), latencies.end(), not_run);
+
+    // the pool completes the tasks it accepted before its destructor returns
+    Pool pool(args...);
+    auto ex = pool.executor();
+
+    std::vector<std::thread> producers;
+
+    for(std::size_t i = 0; i < num_producers; ++i)
+    {
+      producers.emplace_back([&, first = i * tasks_per_producer]
+      {
+        for(std::size_t j = first; j < first + tasks_per_producer; ++j)
+        {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+          // a rejected task is destroyed without running
+          execution::execute(ex, latency_task{clock_type::now(), &latencies[j]});
+#else
+          try
+          {
+            execution::execute(ex, latency_task{clock_type::now(), &latencies[j]});
+          }
+          catch(const std::system_error&)
+          {
+          }
+#endif
+        }
+      });
+    }
+
+    for(std::thread& t : producers)
+    {
+      t.join();
+    }
+  });
+
+  std::vector<std::uint64_t> ran;
+  std::copy_if(latencies.begin(), latencies.end(), std::back_inserter(ran), [](std::uint64_t l){ return l != not_run; });
+  std::sort(ran.begin(), ran.end());
+
+  auto percentile = [&](double p)
+  {
+    return ran.empty() ? 0. : double(ran[std::min(ran.size() - 1, static_cast<std::size_t>(p * ran.size()))]);
+  };
+
+  std::printf("%-72s p50 %9.0f ns  p99 %9.0f ns  p99.9 %9.0f ns  rejected %5.1f%%\n",
+    "",
+    percentile(0.5),
+    percentile(0.99),
+    percentile(0.999),
+    100. * double(num_tasks - ran.size()) / num_tasks
+  );
+}
+
+
+int main(int argc, char** argv)
+{
+  std::size_t num_producers = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4;
+  std::size_t tasks_per_producer = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+
+  std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  measure_latency<thread_pool>("execute(ex, f) [thread_pool, unbounded]", num_producers, tasks_per_producer, num_threads);
+
+  for(auto policy : {static_thread_pool::overflow_policy::reject, static_thread_pool::overflow_policy::caller_runs})
+  {
+    for(std::size_t capacity : {16, 256, 4096, 65536})
+    {
+      char name[128];
+      std::snprintf(name, sizeof(name), "execute(ex, f) [static_thread_pool, capacity %zu, %s]",
+        capacity,
+        policy == static_thread_pool::overflow_policy::reject ? "reject" : "caller_runs"
+      );
+
+      measure_latency<static_thread_pool>(name, num_producers, tasks_per_producer, num_threads, capacity, policy);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+// $ clang-10 -std=c++20 -O3 -I.. strand.cpp -lstdc++ -lpthread
+// $ ./a.out [num_tasks]
+
+// compares serializing work with a strand against serializing it with a mutex, as 1 to 64 producer
+// threads execute num_tasks tasks between them, by default 1M, each of which increments a shared
+// counter which is not atomic
+//
+// a mutex serializes work either by its producers executing it inline upon an execution_context while
+// they hold the lock, or by each task taking the lock as it runs upon a thread_pool. a strand over the
+// thread_pool instead takes no locks: its producers push onto an atomic queue, and one drain at a time
+// runs what they push
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "execution_context.hpp"
+#include "strand.hpp"
+#include "thread_pool.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// runs producer(i) upon each of num_producers threads
+template<class F>
+void run_producers(std::size_t num_producers, F producer)
+{
+  std::vector<std::thread> producers;
+
+  for(std::size_t i = 0; i < num_producers; ++i)
+  {
+    producers.emplace_back(producer);
+  }
+
+  for(std::thread& t : producers)
+  {
+    t.join();
+  }
+}
+
+
+void measure_serialization(std::size_t num_producers, std::size_t num_tasks)
+{
+  std::size_t tasks_per_producer = num_tasks / num_producers;
+  num_tasks = tasks_per_producer * num_producers;
+
+  char name[128];
+
+  {
+    std::size_t counter = 0;
+    std::mutex mutex;
+
+    std::snprintf(name, sizeof(name), "execute(ex, f) holding a mutex [execution_context, %zu producers]", num_producers);
+
+    benchmark::measure(name, num_tasks, [&]
+    {
+      execution_context ctx;
+
+      run_producers(num_producers, [&, ex = ctx.executor()]
+      {
+        for(std::size_t i = 0; i < tasks_per_producer; ++i)
+        {
+          std::lock_guard lock(mutex);
+          execution::execute(ex, [&counter]{ ++counter; });
+        }
+      });
+    });
+
+    benchmark::do_not_optimize(counter);
+  }
+
+  {
+    std::size_t counter = 0;
+    std::mutex mutex;
+
+    std::snprintf(name, sizeof(name), "execute(ex, f), f holding a mutex [thread_pool, %zu producers]", num_producers);
+
+    benchmark::measure(name, num_tasks, [&]
+    {
+      // the pool completes outstanding work before its destructor returns
+      thread_pool pool;
+
+      run_producers(num_producers, [&, ex = pool.executor()]
+      {
+        for(std::size_t i = 0; i < tasks_per_producer; ++i)
+        {
+          execution::execute(ex, [&]
+          {
+            std::lock_guard lock(mutex);
+            ++counter;
+          });
+        }
+      });
+    });
+
+    benchmark::do_not_optimize(counter);
+  }
+
+  {
+    std::size_t counter = 0;
+
+    std::snprintf(name, sizeof(name), "execute(strand, f) [strand over thread_pool, %zu producers]", num_producers);
+
+    benchmark::measure(name, num_tasks, [&]
+    {
+      thread_pool pool;
+      strand s(pool.executor());
+
+      run_producers(num_producers, [&]
+      {
+        for(std::size_t i = 0; i < tasks_per_producer; ++i)
+        {
+          execution::execute(s, [&counter]{ ++counter; });
+        }
+      });
+    });
+
+    benchmark::do_not_optimize(counter);
+  }
+
+  std::printf("\n");
+}
+
+
+int main(int argc, char** argv)
+{
+  std::size_t num_tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+  for(std::size_t num_producers = 1; num_producers <= 64; num_producers *= 2)
+  {
+    measure_serialization(num_producers, num_tasks);
+  }
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+// $ clang-10 -std=c++20 -O3 -I.. submit.cpp -lstdc++ -lpthread
+
+// compares submit's submit_receiver drawn from the global heap with one drawn from pool_allocator,
+// first upon an inline execution_context, where each block is freed upon the thread which allocated
+// it, and then from a producer thread onto a single_thread_context and a thread_pool, where each is
+// freed upon a worker and returned to the producer's cache. the producer keeps at most window
+// operations in flight, so that in steady state its blocks are recycled rather than allocated
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "execution_context.hpp"
+#include "single_thread_context.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+
+
+struct counting_receiver
+{
+  std::size_t* count_;
+
+  void set_value() && noexcept
+  {
+    ++*count_;
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+// opts out of the pool by supplying the global heap, equivalent to plain new/delete
+struct heap_receiver : counting_receiver
+{
+  std::allocator<std::byte> get_allocator() const noexcept
+  {
+    return {};
+  }
+};
+
+
+struct atomic_counting_receiver
+{
+  std::atomic<std::size_t>* count_;
+
+  void set_value() && noexcept
+  {
+    count_->fetch_add(1, std::memory_order_release);
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+struct atomic_heap_receiver : atomic_counting_receiver
+{
+  std::allocator<std::byte> get_allocator() const noexcept
+  {
+    return {};
+  }
+};
+
+
+template<class Receiver, class Executor>
+void measure_cross_thread(const std::string& name, Executor ex, std::size_t n)
+{
+  constexpr std::size_t window = 128;
+
+  benchmark::measure(name.c_str(), n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      while(i - count.load(std::memory_order_acquire) >= window)
+      {
+        std::this_thread::yield();
+      }
+
+      execution::submit(execution::schedule(ex), Receiver{{&count}});
+    }
+
+    while(count.load(std::memory_order_acquire) != n)
+    {
+      std::this_thread::yield();
+    }
+  });
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 10'000'000;
+
+  execution_context ctx;
+  std::size_t count = 0;
+
+  benchmark::measure("submit(schedule(sched), r) [new/delete]", n, [&]
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      execution::submit(execution::schedule(ctx.scheduler()), heap_receiver{{&count}});
+    }
+  });
+
+  benchmark::measure("submit(schedule(sched), r) [pool_allocator]", n, [&]
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      execution::submit(execution::schedule(ctx.scheduler()), counting_receiver{&count});
+    }
+  });
+
+  benchmark::do_not_optimize(count);
+
+  constexpr std::size_t num_cross_thread = 1'000'000;
+
+  {
+    single_thread_context ctx;
+    measure_cross_thread<atomic_heap_receiver>("submit(schedule(ex), r) [single_thread_context, new/delete]", ctx.executor(), num_cross_thread);
+    measure_cross_thread<atomic_counting_receiver>("submit(schedule(ex), r) [single_thread_context, pool_allocator]", ctx.executor(), num_cross_thread);
+  }
+
+  {
+    thread_pool pool;
+    measure_cross_thread<atomic_heap_receiver>("submit(schedule(ex), r) [thread_pool, new/delete]", pool.executor(), num_cross_thread);
+    measure_cross_thread<atomic_counting_receiver>("submit(schedule(ex), r) [thread_pool, pool_allocator]", pool.executor(), num_cross_thread);
+  }
+
+  return 0;
+}
+
@@ -0,0 +1,129 @@
+// $ clang-10 -std=c++20 -O3 -I.. submit_batch.cpp -lstdc++ -lpthread
+
+// compares submitting fan-outs of work one item at a time against submit_batch and execute_batch,
+// which enqueue a whole fan-out in one queue transaction
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "single_thread_context.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+struct counting_receiver
+{
+  std::atomic<std::size_t>* count_;
+
+  void set_value() && noexcept
+  {
+    count_->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+struct counting_function
+{
+  std::atomic<std::size_t>* count_;
+
+  void operator()() const noexcept
+  {
+    count_->fetch_add(1, std::memory_order_relaxed);
+  }
+};
+
+
+void wait_for(const std::atomic<std::size_t>& count, std::size_t n)
+{
+  while(count.load(std::memory_order_relaxed) != n)
+  {
+    std::this_thread::yield();
+  }
+}
+
+
+// measures n operations dispatched in fan-outs of fan_out items; dispatch(items) consumes a fan-out
+template<class T, class F>
+void measure_fan_out(const std::string& name, std::size_t n, std::size_t fan_out, F dispatch)
+{
+  std::vector<T> items;
+  items.reserve(fan_out);
+
+  benchmark::measure(name.c_str(), n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t i = 0; i < n; i += fan_out)
+    {
+      items.assign(fan_out, T{&count});
+      dispatch(items);
+    }
+
+    wait_for(count, n);
+  });
+}
+
+
+template<class Executor>
+void measure_executor(const std::string& executor_name, Executor ex, std::size_t n)
+{
+  for(std::size_t fan_out : {1, 4, 16, 64, 256})
+  {
+    auto name = [&](const char* path)
+    {
+      return executor_name + ": " + path + ", fan-out " + std::to_string(fan_out);
+    };
+
+    measure_fan_out<counting_receiver>(name("submit per item"), n, fan_out, [&](std::vector<counting_receiver>& receivers)
+    {
+      for(counting_receiver& r : receivers)
+      {
+        execution::submit(execution::schedule(ex), std::move(r));
+      }
+    });
+
+    measure_fan_out<counting_receiver>(name("submit_batch"), n, fan_out, [&](std::vector<counting_receiver>& receivers)
+    {
+      execution::submit_batch(execution::schedule(ex), receivers);
+    });
+
+    measure_fan_out<counting_function>(name("execute per item"), n, fan_out, [&](std::vector<counting_function>& fs)
+    {
+      for(counting_function& f : fs)
+      {
+        execution::execute(ex, std::move(f));
+      }
+    });
+
+    measure_fan_out<counting_function>(name("execute_batch"), n, fan_out, [&](std::vector<counting_function>& fs)
+    {
+      execution::execute_batch(ex, fs);
+    });
+  }
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 1 << 20;
+
+  {
+    single_thread_context ctx;
+    measure_executor("single_thread_context", ctx.executor(), n);
+  }
+
+  {
+    thread_pool pool;
+    measure_executor("thread_pool", pool.executor(), n);
+  }
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+// $ clang-10 -std=c++20 -O3 -I.. sync_wait.cpp -lstdc++ -lpthread
+
+// measures ping-pong latency: each round trip hands work to another thread with execution::schedule
+// and blocks the calling thread until it completes. sync_wait's spin-then-atomic-wait event is
+// compared against the same wait built from a mutex and condition variable
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "execution_context.hpp"
+#include "sender_algorithms.hpp"
+#include "single_thread_context.hpp"
+#include "thread_pool.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+
+// the blocking wait sync_wait replaces
+struct condvar_receiver
+{
+  std::mutex* mutex_;
+  std::condition_variable* cv_;
+  bool* done_;
+
+  void set_value() && noexcept
+  {
+    {
+      std::lock_guard lock(*mutex_);
+      *done_ = true;
+    }
+
+    cv_->notify_one();
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept
+  {
+    std::move(*this).set_value();
+  }
+
+  void set_done() && noexcept
+  {
+    std::move(*this).set_value();
+  }
+};
+
+
+template<class S>
+void condvar_sync_wait(S&& s)
+{
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+
+  auto op = execution::connect(std::forward<S>(s), condvar_receiver{&mutex, &cv, &done});
+  execution::start(op);
+
+  std::unique_lock lock(mutex);
+  cv.wait(lock, [&]{ return done; });
+}
+
+
+template<class Executor>
+void measure_executor(const std::string& executor_name, Executor ex, std::size_t n)
+{
+  auto name = [&](const char* path)
+  {
+    return executor_name + ": " + path;
+  };
+
+  benchmark::measure(name("sync_wait(schedule(ex)) round trip").c_str(), n, [&]
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      execution::sync_wait(execution::schedule(ex));
+    }
+  });
+
+  benchmark::measure(name("mutex + condition_variable round trip").c_str(), n, [&]
+  {
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      condvar_sync_wait(execution::schedule(ex));
+    }
+  });
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 200'000;
+
+  {
+    execution_context ctx;
+    measure_executor("inline", ctx.executor(), n);
+  }
+
+  {
+    single_thread_context ctx;
+    measure_executor("single_thread_context", ctx.executor(), n);
+  }
+
+  {
+    thread_pool pool;
+    measure_executor("thread_pool", pool.executor(), n);
+  }
+
+  return 0;
+}
@@ -0,0 +1,121 @@
+// $ clang-10 -std=c++20 -O3 -I.. task.cpp -lstdc++ -lpthread
+
+// compares hopping onto an executor from a coroutine with co_await execution::schedule(ex)
+// against the same sequence of hops written in callback style with execution::submit
+//
+// hops are made in chains of hops_per_chain because the callback chain recurses when the
+// executor runs work inline
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "execution_context.hpp"
+#include "sender_algorithms.hpp"
+#include "single_thread_context.hpp"
+#include "task.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+
+constexpr std::size_t hops_per_chain = 100;
+
+
+template<class Executor>
+execution::task<std::size_t> hop(Executor ex, std::size_t n)
+{
+  std::size_t result = 0;
+
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    co_await execution::schedule(ex);
+    ++result;
+  }
+
+  co_return result;
+}
+
+
+// each hop submits the next onto the same executor
+template<class Executor>
+struct hop_receiver
+{
+  Executor ex_;
+  std::size_t remaining_;
+  std::atomic<bool>* done_;
+
+  void set_value() && noexcept
+  {
+    if(--remaining_ == 0)
+    {
+      done_->store(true, std::memory_order_release);
+    }
+    else
+    {
+      execution::submit(execution::schedule(ex_), std::move(*this));
+    }
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept {}
+};
+
+
+template<class Executor>
+void measure_executor(const std::string& executor_name, Executor ex, std::size_t n)
+{
+  auto name = [&](const char* path)
+  {
+    return executor_name + ": " + path;
+  };
+
+  benchmark::measure(name("co_await schedule(ex) [task]").c_str(), n, [&]
+  {
+    for(std::size_t i = 0; i < n; i += hops_per_chain)
+    {
+      auto result = execution::sync_wait(hop(ex, hops_per_chain));
+      benchmark::do_not_optimize(result);
+    }
+  });
+
+  benchmark::measure(name("submit(schedule(ex), r) [callback]").c_str(), n, [&]
+  {
+    for(std::size_t i = 0; i < n; i += hops_per_chain)
+    {
+      std::atomic<bool> done{false};
+
+      execution::submit(execution::schedule(ex), hop_receiver<Executor>{ex, hops_per_chain, &done});
+
+      while(!done.load(std::memory_order_acquire))
+      {
+        std::this_thread::yield();
+      }
+    }
+  });
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 1'000'000;
+
+  {
+    execution_context ctx;
+    measure_executor("inline", ctx.executor(), n);
+  }
+
+  {
+    single_thread_context ctx;
+    measure_executor("single_thread_context", ctx.executor(), n);
+  }
+
+  {
+    thread_pool pool;
+    measure_executor("thread_pool", pool.executor(), n);
+  }
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+// $ clang-10 -std=c++20 -O3 -I.. thread_pool.cpp -lstdc++ -lpthread
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// the baseline: every worker shares a single mutex-protected FIFO
+class mutex_queue_pool
+{
+  public:
+    explicit mutex_queue_pool(std::size_t num_threads)
+    {
+      for(std::size_t i = 0; i < num_threads; ++i)
+      {
+        threads_.emplace_back([this]{ run(); });
+      }
+    }
+
+    ~mutex_queue_pool()
+    {
+      {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+      }
+
+      cv_.notify_all();
+
+      for(std::thread& t : threads_)
+      {
+        t.join();
+      }
+    }
+
+    struct executor_type
+    {
+      mutex_queue_pool* pool_;
+
+      template<class F>
+        requires invocable<remove_cvref_t<F>&>
+      void execute(F&& f) const
+      {
+        {
+          std::lock_guard lock(pool_->mutex_);
+          pool_->queue_.emplace_back(std::forward<F>(f));
+        }
+
+        pool_->cv_.notify_one();
+      }
+
+      friend bool operator==(const executor_type& a, const executor_type& b)
+      {
+        return a.pool_ == b.pool_;
+      }
+
+      friend bool operator!=(const executor_type& a, const executor_type& b)
+      {
+        return !(a == b);
+      }
+    };
+
+    executor_type executor()
+    {
+      return {this};
+    }
+
+  private:
+    void run()
+    {
+      std::unique_lock lock(mutex_);
+
+      while(true)
+      {
+        cv_.wait(lock, [&]{ return stopping_ or !queue_.empty(); });
+
+        if(queue_.empty())
+        {
+          break;
+        }
+
+        std::function<void()> f = std::move(queue_.front());
+        queue_.pop_front();
+
+        lock.unlock();
+        f();
+        lock.lock();
+      }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
+
+static_assert(execution::executor<mutex_queue_pool::executor_type>);
+
+
+// a binary fork tree: each task above the leaves executes two children
+template<class Executor>
+void fork(Executor ex, int depth, std::atomic<std::size_t>& count)
+{
+  if(depth > 0)
+  {
+    execution::execute(ex, [ex,depth,&count]{ fork(ex, depth - 1, count); });
+    execution::execute(ex, [ex,depth,&count]{ fork(ex, depth - 1, count); });
+  }
+
+  count.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+template<class Pool>
+void measure_fork(const char* pool_name, std::size_t num_threads, int depth)
+{
+  std::size_t num_tasks = (std::size_t(1) << (depth + 1)) - 1;
+
+  char name[128];
+  std::snprintf(name, sizeof(name), "%s fork tree, %zu threads", pool_name, num_threads);
+
+  Pool pool(num_threads);
+
+  benchmark::measure(name, num_tasks, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    fork(pool.executor(), depth, count);
+
+    while(count.load(std::memory_order_relaxed) != num_tasks)
+    {
+      std::this_thread::yield();
+    }
+  });
+}
+
+
+int main()
+{
+  constexpr int depth = 20;
+
+  std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  // 1, 2, 4, ... up to and including the number of hardware threads
+  std::vector<std::size_t> thread_counts;
+
+  for(std::size_t n = 1; n < max_threads; n *= 2)
+  {
+    thread_counts.push_back(n);
+  }
+
+  thread_counts.push_back(max_threads);
+
+  for(std::size_t n : thread_counts)
+  {
+    measure_fork<mutex_queue_pool>("mutex_queue_pool", n, depth);
+    measure_fork<thread_pool>("thread_pool", n, depth);
+  }
+
+  return 0;
+}
+
@@ -0,0 +1,115 @@
+// $ clang-10 -std=c++20 -O3 -I.. timer_context.cpp -lstdc++ -lpthread
+
+#include "harness.hpp"
+#include "execution.hpp"
+#include "timer_context.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+struct counting_receiver
+{
+  std::atomic<std::size_t>* count_;
+
+  void set_value() && noexcept
+  {
+    count_->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  template<class E>
+  void set_error(E&&) && noexcept {}
+
+  void set_done() && noexcept
+  {
+    count_->fetch_add(1, std::memory_order_relaxed);
+  }
+};
+
+
+using operation_type = execution::connect_result_t<timer_context::sender_type, counting_receiver>;
+
+
+void wait_for(const std::atomic<std::size_t>& count, std::size_t n)
+{
+  while(count.load(std::memory_order_relaxed) != n)
+  {
+    std::this_thread::yield();
+  }
+}
+
+
+int main()
+{
+  constexpr std::size_t n = 1'000'000;
+
+  timer_context ctx;
+  auto sched = ctx.scheduler();
+
+  std::allocator<operation_type> alloc;
+  operation_type* operations = alloc.allocate(n);
+
+  std::mt19937 rng(0);
+
+  // deadlines spread over ten minutes exercise every level of the wheel
+  std::vector<std::chrono::milliseconds> far_delays(n);
+  for(auto& delay : far_delays)
+  {
+    delay = std::chrono::milliseconds(1000 + rng() % 600'000);
+  }
+
+  // deadlines spread over 50ms fire within the measurement
+  std::vector<std::chrono::milliseconds> near_delays(n);
+  for(auto& delay : near_delays)
+  {
+    delay = std::chrono::milliseconds(rng() % 50);
+  }
+
+  benchmark::measure("schedule_after + start, then cancel", n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      operation_type* op = ::new(static_cast<void*>(operations + i)) operation_type(
+        execution::connect(execution::schedule_after(sched, far_delays[i]), counting_receiver{&count})
+      );
+
+      execution::start(*op);
+    }
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      operations[i].cancel();
+    }
+
+    wait_for(count, n);
+    std::destroy_n(operations, n);
+  });
+
+  benchmark::measure("schedule_after + start, then fire (within 50ms)", n, [&]
+  {
+    std::atomic<std::size_t> count{0};
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      operation_type* op = ::new(static_cast<void*>(operations + i)) operation_type(
+        execution::connect(execution::schedule_after(sched, near_delays[i]), counting_receiver{&count})
+      );
+
+      execution::start(*op);
+    }
+
+    wait_for(count, n);
+    std::destroy_n(operations, n);
+  });
+
+  alloc.deallocate(operations, n);
+
+  return 0;
+}
+
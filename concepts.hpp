@@ -5,16 +5,41 @@
 #include <utility>
 
 
+// these concepts are checked for every executor, receiver and adapted type that passes through a CPO,
+// so they avoid the standard type traits: libstdc++ verifies that their arguments are complete through
+// several layers of templates, which made those traits the largest cost of checking the concepts
+
+
+namespace detail
+{
+
+
+template<class To>
+void implicitly_convert_to(To) noexcept;
+
+
+// is_convertible_v, except that conversions to void are not considered
+template<class From, class To>
+concept implicitly_convertible_to = requires { detail::implicitly_convert_to<To>(std::declval<From>()); };
+
+
+template<class T>
+concept nothrow_destructible_object = requires(T& t) { { t.~T() } noexcept; };
+
+
+} // end detail
+
+
 template<class Derived, class Base>
 concept derived_from =
-  std::is_base_of_v<Base, Derived> and
-  std::is_convertible_v<const volatile Derived*, const volatile Base*>
+  __is_base_of(Base, Derived) and
+  detail::implicitly_convertible_to<const volatile Derived*, const volatile Base*>
 ;
 
 
 template<class From, class To>
 concept convertible_to =
-  std::is_convertible_v<From, To> and
+  detail::implicitly_convertible_to<From, To> and
   requires(std::add_rvalue_reference_t<From> (&f)())
   {
     static_cast<To>(f());
@@ -23,11 +48,19 @@ concept convertible_to =
 
 
 template<class T>
-concept destructible = std::is_nothrow_destructible_v<T>;
+concept destructible =
+  std::is_reference_v<T> or
+  (!std::is_unbounded_array_v<T> and detail::nothrow_destructible_object<std::remove_all_extents_t<T>>)
+;
+
+
+template<class T, class... Args>
+concept constructible_from = destructible<T> and __is_constructible(T, Args...);
 
 
+// is_nothrow_constructible_v, which the standard library does not provide as a concept
 template<class T, class... Args>
-concept constructible_from = destructible<T> and std::is_constructible_v<T,Args...>;
+concept nothrow_constructible_from = constructible_from<T, Args...> and __is_nothrow_constructible(T, Args...);
 
 
 template<class T>
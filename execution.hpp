@@ -1,9 +1,18 @@
 #pragma once
 
 #include "concepts.hpp"
+#include "pool_allocator.hpp"
+#include "stop_token.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <exception>
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <optional>
+#include <system_error>
+#include <thread>
 #include <type_traits>
 #include <utility>
 
@@ -12,8 +21,30 @@ template<class T>
 using remove_cvref_t = std::remove_cv_t<std::remove_reference_t<T>>;
 
 
+// EXECUTION_NO_EXCEPTIONS selects the exception-free error channel. it is defined automatically when
+// exceptions are disabled, and may be defined by builds which enable exceptions but cannot afford
+// their handlers on the paths between executors, senders, and receivers
+//
+// in this configuration, errors travel through set_error as std::error_code values rather than as
+// std::exception_ptr, and the adaptations in this header compile without any try or catch. work which
+// throws anyway terminates, as would any exception escaping a noexcept function
+#if !defined(EXECUTION_NO_EXCEPTIONS) and !defined(__cpp_exceptions)
+#define EXECUTION_NO_EXCEPTIONS
+#endif
+
+
 namespace execution
 {
+
+
+// the type of error delivered by the adaptations in this header, and the error every receiver must accept
+#if defined(EXECUTION_NO_EXCEPTIONS)
+using error_type = std::error_code;
+#else
+using error_type = std::exception_ptr;
+#endif
+
+
 namespace detail
 {
 
@@ -127,7 +158,7 @@ struct set_done_t
 constexpr detail::set_done_t set_done{};
 
 
-template<class T, class E = std::exception_ptr>
+template<class T, class E = error_type>
 concept receiver = 
   move_constructible<remove_cvref_t<T>> and
   constructible_from<remove_cvref_t<T>, T> and
@@ -186,7 +217,10 @@ concept receiver_of =
 template<class R, class... An>
 inline constexpr bool is_nothrow_receiver_of_v =
   receiver_of<R,An...> and
-  std::is_nothrow_invocable_v<decltype(set_value), R, An...>
+  requires(R&& r, An&&... an)
+  {
+    { execution::set_value(std::forward<R>(r), std::forward<An>(an)...) } noexcept;
+  }
 ;
 
 
@@ -272,6 +306,64 @@ namespace detail
 {
 
 
+template<class R>
+concept has_get_stop_token_member_function = requires(R&& r) { std::forward<R>(r).get_stop_token(); };
+
+template<class R>
+concept has_get_stop_token_free_function = requires(R&& r) { get_stop_token(std::forward<R>(r)); };
+
+struct get_stop_token_t
+{
+  template<class R>
+    requires has_get_stop_token_member_function<R&&>
+  constexpr auto operator()(R&& r) const noexcept
+  {
+    return std::forward<R>(r).get_stop_token();
+  }
+
+  template<class R>
+    requires (!has_get_stop_token_member_function<R&&> and has_get_stop_token_free_function<R&&>)
+  constexpr auto operator()(R&& r) const noexcept
+  {
+    return get_stop_token(std::forward<R>(r));
+  }
+
+  template<class R>
+    requires (!has_get_stop_token_member_function<R&&> and !has_get_stop_token_free_function<R&&>)
+  constexpr never_stop_token operator()(R&&) const noexcept
+  {
+    return {};
+  }
+};
+
+
+} // end detail
+
+
+// receivers report cancellation requests through the stop token returned by get_stop_token
+// scheduled work whose receiver's stop has been requested completes with set_done
+constexpr detail::get_stop_token_t get_stop_token{};
+
+
+template<class R>
+using stop_token_of_t = remove_cvref_t<decltype(execution::get_stop_token(std::declval<R>()))>;
+
+
+// specializing is_inline_executor to true asserts that executing an invocable on E is
+// equivalent to invoking it immediately on the calling thread
+//
+// execution::connect and execution::execute use this to complete receivers directly instead of adapting them
+template<class E>
+struct is_inline_executor : std::false_type {};
+
+template<class E>
+inline constexpr bool is_inline_executor_v = is_inline_executor<remove_cvref_t<E>>::value;
+
+
+namespace detail
+{
+
+
 template<class E, class F>
 concept has_execute_member_function = requires(E&& e, F&& f) { std::forward<E>(e).execute(std::forward<F>(f)); };
 
@@ -307,7 +399,7 @@ concept custom_executor_of =
   constructible_from<remove_cvref_t<F>, F> and
   move_constructible<remove_cvref_t<F>> and
   copy_constructible<E> and
-  std::is_nothrow_copy_constructible_v<E> and
+  nothrow_constructible_from<E, const E&> and
   equality_comparable<E> and
   has_custom_execute<const E&, F>
 ;
@@ -353,6 +445,53 @@ concept custom_sender_to =
 ;
 
 
+// completes r with set_value, delivering anything set_value throws through set_error
+// no handler is compiled for nothrow receivers, or without exceptions
+template<class R, class... As>
+constexpr void set_value_or_error(R&& r, As&&... as) noexcept
+{
+#if defined(EXECUTION_NO_EXCEPTIONS)
+  execution::set_value(std::move(r), std::forward<As>(as)...);
+#else
+  if constexpr(is_nothrow_receiver_of_v<R, As...>)
+  {
+    execution::set_value(std::move(r), std::forward<As>(as)...);
+  }
+  else
+  {
+    try
+    {
+      execution::set_value(std::move(r), std::forward<As>(as)...);
+    }
+    catch(...)
+    {
+      execution::set_error(std::move(r), std::current_exception());
+    }
+  }
+#endif
+}
+
+
+// invokes f, which is expected to complete r, and completes r with set_error instead if f throws
+// without exceptions, no handler is compiled, and f must not throw
+template<class R, class F>
+constexpr void invoke_or_set_error([[maybe_unused]] R& r, F&& f) noexcept
+{
+#if defined(EXECUTION_NO_EXCEPTIONS)
+  std::invoke(std::forward<F>(f));
+#else
+  try
+  {
+    std::invoke(std::forward<F>(f));
+  }
+  catch(...)
+  {
+    execution::set_error(std::move(r), std::current_exception());
+  }
+#endif
+}
+
+
 template<class R, class>
 struct as_invocable
 {
@@ -375,17 +514,79 @@ struct as_invocable
     }
   }
 
-  void operator()() & noexcept try
+  void operator()() & noexcept
   {
     // XXX indirection is pessimization
-    execution::set_value(std::move(*r_));
-    r_ = nullptr;
+    R& r = *std::exchange(r_, nullptr);
+
+    if(execution::get_stop_token(r).stop_requested())
+    {
+      execution::set_done(std::move(r));
+    }
+    else
+    {
+      detail::set_value_or_error(std::move(r));
+    }
   }
-  catch(...)
+};
+
+// as_value_invocable is the alternative to as_invocable used when the receiver can be
+// moved without throwing: the receiver travels with the invocable, so there is no
+// indirection and the operation which created it need not outlive the call to execute
+template<class R, class>
+struct as_value_invocable
+{
+  // the receiver lives in a union rather than a std::optional, because instantiating std::optional
+  // as a member is by far the largest compile-time cost of connecting a receiver to an executor
+  union
   {
-    // XXX indirection is pessimization
-    execution::set_error(std::move(*r_), std::current_exception());
-    r_ = nullptr;
+    R r_;
+  };
+
+  bool has_receiver_;
+
+  explicit as_value_invocable(R&& r) noexcept
+    : r_(std::move(r)),
+      has_receiver_(true)
+  {}
+
+  as_value_invocable(as_value_invocable&& other) noexcept
+    : has_receiver_(other.has_receiver_)
+  {
+    if(has_receiver_)
+    {
+      ::new(static_cast<void*>(std::addressof(r_))) R(std::move(other.r_));
+      other.reset();
+    }
+  }
+
+  ~as_value_invocable()
+  {
+    if(has_receiver_)
+    {
+      execution::set_done(std::move(r_));
+      reset();
+    }
+  }
+
+  void reset() noexcept
+  {
+    r_.~R();
+    has_receiver_ = false;
+  }
+
+  void operator()() & noexcept
+  {
+    if(execution::get_stop_token(r_).stop_requested())
+    {
+      execution::set_done(std::move(r_));
+    }
+    else
+    {
+      detail::set_value_or_error(std::move(r_));
+    }
+
+    reset();
   }
 };
 
@@ -395,6 +596,9 @@ struct is_as_invocable : std::false_type {};
 template<class T, class U>
 struct is_as_invocable<as_invocable<T,U>> : std::true_type {};
 
+template<class T, class U>
+struct is_as_invocable<as_value_invocable<T,U>> : std::true_type {};
+
 template<class T>
 inline constexpr bool is_as_invocable_v = is_as_invocable<T>::value;
 
@@ -404,12 +608,14 @@ struct as_receiver
 {
   F f_;
 
-  void set_value() noexcept(std::is_nothrow_invocable_v<F&>)
+  void set_value() noexcept(noexcept(f_()))
   {
     std::invoke(f_);
   }
 
-  [[noreturn]] void set_error(std::exception_ptr) noexcept
+  // execute has no channel through which to report the error to its caller
+  template<class E>
+  [[noreturn]] void set_error(E&&) noexcept
   {
     std::terminate();
   }
@@ -427,6 +633,100 @@ template<class T>
 inline constexpr bool is_as_receiver_v = is_as_receiver<T>::value;
 
 
+// selects as_value_invocable over as_invocable in connect's executor fallback
+template<class E, class R, class S>
+concept custom_executor_of_value_receiver =
+  nothrow_constructible_from<R, R> and
+  custom_executor_of<E, as_value_invocable<R, S>>
+;
+
+
+// the operations of connect's executor fallbacks are named class templates rather than local classes,
+// so that checking whether an executor can connect a receiver does not instantiate their start functions
+
+
+template<class R>
+struct inline_receiver_operation
+{
+  R r_;
+
+  void start() noexcept
+  {
+    if(execution::get_stop_token(r_).stop_requested())
+    {
+      execution::set_done(std::move(r_));
+    }
+    else
+    {
+      detail::set_value_or_error(std::move(r_));
+    }
+  }
+};
+
+
+template<class S, class R>
+struct as_value_invocable_operation
+{
+  remove_cvref_t<S> e_;
+  R r_;
+
+  void start() noexcept
+  {
+    as_value_invocable<R, S> f{std::move(r_)};
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+    detail::custom_execute(std::move(e_), std::move(f));
+#else
+    try
+    {
+      detail::custom_execute(std::move(e_), std::move(f));
+    }
+    catch(...)
+    {
+      // only report the error if the executor did not take ownership of the receiver
+      if(f.has_receiver_)
+      {
+        execution::set_error(std::move(f.r_), std::current_exception());
+        f.reset();
+      }
+    }
+#endif
+  }
+};
+
+
+template<class S, class R>
+struct as_invocable_operation
+{
+  remove_cvref_t<S> e_;
+  R r_;
+
+  void start() noexcept
+  {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+    detail::custom_execute(std::move(e_), as_invocable<R, S>{r_});
+#else
+    as_invocable<R, S> f{r_};
+
+    try
+    {
+      detail::custom_execute(std::move(e_), std::move(f));
+    }
+    catch(...)
+    {
+      // only report the error if the executor did not take ownership of the receiver,
+      // whose set_done the invocable would otherwise call as it is destroyed
+      if(f.r_)
+      {
+        f.r_ = nullptr;
+        execution::set_error(std::move(r_), std::current_exception());
+      }
+    }
+#endif
+  }
+};
+
+
 struct connect_t
 {
   template<sender S, class R>
@@ -439,26 +739,34 @@ struct connect_t
   template<class S, receiver_of R>
     requires (!has_custom_connect<S&&,R&&> and
               !is_as_receiver_v<remove_cvref_t<R>> and
-              custom_executor_of<remove_cvref_t<S>, as_invocable<remove_cvref_t<R>, S>>
+              is_inline_executor_v<S>
              )
-  constexpr operation_state auto operator()(S&& s, R&& r) const
+  constexpr inline_receiver_operation<remove_cvref_t<R>> operator()(S&&, R&& r) const
   {
-    struct as_operation
-    {
-      remove_cvref_t<S> e_;
-      remove_cvref_t<R> r_;
+    return {std::forward<R>(r)};
+  }
 
-      void start() noexcept try
-      {
-        detail::custom_execute(std::move(e_), as_invocable<remove_cvref_t<R>, S>{r_});
-      }
-      catch(...)
-      {
-        execution::set_error(std::move(r_), std::current_exception());
-      }
-    };
+  template<class S, receiver_of R>
+    requires (!has_custom_connect<S&&,R&&> and
+              !is_as_receiver_v<remove_cvref_t<R>> and
+              !is_inline_executor_v<S> and
+              custom_executor_of_value_receiver<remove_cvref_t<S>, remove_cvref_t<R>, S>
+             )
+  constexpr as_value_invocable_operation<S, remove_cvref_t<R>> operator()(S&& s, R&& r) const
+  {
+    return {std::forward<S>(s), std::forward<R>(r)};
+  }
 
-    return as_operation{std::forward<S>(s), std::forward<R>(r)};
+  template<class S, receiver_of R>
+    requires (!has_custom_connect<S&&,R&&> and
+              !is_as_receiver_v<remove_cvref_t<R>> and
+              !is_inline_executor_v<S> and
+              !custom_executor_of_value_receiver<remove_cvref_t<S>, remove_cvref_t<R>, S> and
+              custom_executor_of<remove_cvref_t<S>, as_invocable<remove_cvref_t<R>, S>>
+             )
+  constexpr as_invocable_operation<S, remove_cvref_t<R>> operator()(S&& s, R&& r) const
+  {
+    return {std::forward<S>(s), std::forward<R>(r)};
   }
 };
 
@@ -488,6 +796,47 @@ namespace detail
 {
 
 
+template<class R>
+concept has_get_allocator_member_function = requires(R&& r) { std::forward<R>(r).get_allocator(); };
+
+template<class R>
+concept has_get_allocator_free_function = requires(R&& r) { get_allocator(std::forward<R>(r)); };
+
+struct get_allocator_t
+{
+  template<class R>
+    requires has_get_allocator_member_function<R&&>
+  constexpr auto operator()(R&& r) const noexcept
+  {
+    return std::forward<R>(r).get_allocator();
+  }
+
+  template<class R>
+    requires (!has_get_allocator_member_function<R&&> and has_get_allocator_free_function<R&&>)
+  constexpr auto operator()(R&& r) const noexcept
+  {
+    return get_allocator(std::forward<R>(r));
+  }
+
+  template<class R>
+    requires (!has_get_allocator_member_function<R&&> and !has_get_allocator_free_function<R&&>)
+  constexpr pool_allocator<std::byte> operator()(R&&) const noexcept
+  {
+    return {};
+  }
+};
+
+
+} // end detail
+
+
+constexpr detail::get_allocator_t get_allocator{};
+
+
+namespace detail
+{
+
+
 template<class S, class R>
 concept has_submit_member_function = requires(S&& s, R&& r) { std::forward<S>(s).submit(std::forward<R>(r)); };
 
@@ -497,8 +846,17 @@ concept has_submit_free_function = requires(S&& s, R&& r) { submit(std::forward<
 template<class S, class R>
 struct submit_receiver
 {
+  using allocator_type = typename std::allocator_traits<
+    decltype(execution::get_allocator(std::declval<const remove_cvref_t<R>&>()))
+  >::template rebind_alloc<submit_receiver>;
+
+  using allocator_traits = std::allocator_traits<allocator_type>;
+
   struct wrap
   {
+    // identifies receivers created by submit's fallback, which heap-allocates their operation
+    using submit_receiver_type = submit_receiver;
+
     submit_receiver* p_;
 
     template<class... As>
@@ -506,7 +864,7 @@ struct submit_receiver
     void set_value(As&&... as) && noexcept(is_nothrow_receiver_of_v<R, As...>)
     {
       execution::set_value(std::move(p_->r_), std::forward<As>(as)...);
-      delete p_;
+      p_->destroy();
     }
 
     template<class E>
@@ -514,26 +872,68 @@ struct submit_receiver
     void set_error(E&& e) && noexcept
     {
       execution::set_error(std::move(p_->r_), std::forward<E>(e));
-      delete p_;
+      p_->destroy();
     }
 
     void set_done() && noexcept
     {
       execution::set_done(std::move(p_->r_));
-      delete p_;
+      p_->destroy();
+    }
+
+    auto get_stop_token() const noexcept
+    {
+      return execution::get_stop_token(p_->r_);
     }
   };
 
   remove_cvref_t<R> r_;
+  allocator_type alloc_;
   connect_result_t<S, wrap> state_;
 
-  submit_receiver(S&& s, R&& r)
+  submit_receiver(S&& s, R&& r, const allocator_type& alloc)
     : r_(std::forward<R&&>(r)),
+      alloc_(alloc),
       state_(execution::connect(std::forward<S>(s), wrap{this}))
   {}
+
+  // storage is obtained from the receiver's allocator, which defaults to pool_allocator
+  static submit_receiver* make(S&& s, R&& r)
+  {
+    allocator_type alloc(execution::get_allocator(std::as_const(r)));
+
+    submit_receiver* result = allocator_traits::allocate(alloc, 1);
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+    allocator_traits::construct(alloc, result, std::forward<S>(s), std::forward<R>(r), alloc);
+#else
+    try
+    {
+      allocator_traits::construct(alloc, result, std::forward<S>(s), std::forward<R>(r), alloc);
+    }
+    catch(...)
+    {
+      allocator_traits::deallocate(alloc, result, 1);
+      throw;
+    }
+#endif
+
+    return result;
+  }
+
+  void destroy() noexcept
+  {
+    allocator_type alloc(std::move(alloc_));
+    allocator_traits::destroy(alloc, this);
+    allocator_traits::deallocate(alloc, this, 1);
+  }
 };
 
 
+template<class R>
+inline constexpr bool is_submit_receiver_v = requires { typename remove_cvref_t<R>::submit_receiver_type; };
+
+
 struct submit_t
 {
   template<class S, class R>
@@ -551,10 +951,10 @@ struct submit_t
   }
 
   template<class S, class R>
-    requires sender_to<S,R> and (!has_submit_member_function<S&&,R&&> and !has_submit_member_function<S&&,R&&>)
+    requires sender_to<S,R> and (!has_submit_member_function<S&&,R&&> and !has_submit_free_function<S&&,R&&>)
   constexpr void operator()(S&& s, R&& r) const
   {
-    execution::start((new submit_receiver<S, R>(std::forward<S>(s), std::forward<R>(r)))->state_);
+    execution::start(submit_receiver<S, R>::make(std::forward<S>(s), std::forward<R>(r))->state_);
   }
 };
 
@@ -587,6 +987,24 @@ struct execute_t
   {
     return execution::submit(std::forward<E>(e), as_receiver<remove_cvref_t<F>, E>{std::forward<F>(f)});
   }
+
+  // inline executors execute receivers of void directly
+  template<class E, class R>
+    requires(is_inline_executor_v<E> and
+             !invocable<remove_cvref_t<R>&> and
+             receiver_of<R>
+            )
+  constexpr void operator()(E&&, R&& r) const noexcept
+  {
+    if(execution::get_stop_token(r).stop_requested())
+    {
+      execution::set_done(std::move(r));
+    }
+    else
+    {
+      detail::set_value_or_error(std::move(r));
+    }
+  }
 };
 
 
@@ -606,7 +1024,7 @@ concept executor_of_impl =
   constructible_from<remove_cvref_t<F>, F> and
   move_constructible<remove_cvref_t<F>> and
   copy_constructible<E> and
-  std::is_nothrow_copy_constructible_v<E> and
+  nothrow_constructible_from<E, const E&> and
   equality_comparable<E> and
   requires(const E& e, F&& f)
   {
@@ -618,21 +1036,28 @@ concept executor_of_impl =
 struct void_receiver
 {
   void set_value() noexcept;
-  void set_error(std::exception_ptr) noexcept;
+  void set_error(error_type) noexcept;
   void set_done() noexcept;
 };
 
 
 // XXX this specialization allows executors to automatically behave like sender of void
+//
+//     executing an as_invocable is only ever dispatched to custom_execute, so custom_executor_of is
+//     equivalent to executor_of_impl here, but does not resolve execution::execute's overloads. types
+//     which declare their sender types never reach this check
 template<class S>
-  requires executor_of_impl<S, as_invocable<void_receiver, S>>
+  requires (!has_sender_types<S> and
+            !derived_from<S, execution::sender_base> and
+            custom_executor_of<S, as_invocable<void_receiver, S>>
+           )
 struct sender_traits_base<S>
 {
   template<template<class...> class Tuple, template<class...> class Variant>
   using value_types = Variant<Tuple<>>;
 
   template<template<class...> class Variant>
-  using error_types = Variant<std::exception_ptr>;
+  using error_types = Variant<error_type>;
 
   static constexpr bool sends_done = true;
 };
@@ -675,7 +1100,7 @@ class as_sender
     using value_types = Variant<Tuple<>>;
 
     template<template<class...> class Variant>
-    using error_types = Variant<std::exception_ptr>;
+    using error_types = Variant<error_type>;
 
     static constexpr bool sends_done = true;
 
@@ -713,7 +1138,7 @@ struct schedule_t
   }
 
   template<executor S>
-    requires (!has_schedule_free_function<S&&> and !has_schedule_free_function<S&&>)
+    requires (!has_schedule_member_function<S&&> and !has_schedule_free_function<S&&>)
   constexpr sender auto operator()(S&& s) const
   {
     return as_sender<remove_cvref_t<S>>{std::forward<S>(s)};
@@ -738,5 +1163,632 @@ concept scheduler =
 ;
 
 
+namespace detail
+{
+
+
+template<class S, class T>
+concept has_schedule_at_member_function = requires(S&& s, T&& tp) { std::forward<S>(s).schedule_at(std::forward<T>(tp)); };
+
+template<class S, class T>
+concept has_schedule_at_free_function = requires(S&& s, T&& tp) { schedule_at(std::forward<S>(s), std::forward<T>(tp)); };
+
+struct schedule_at_t
+{
+  template<class S, class T>
+    requires has_schedule_at_member_function<S&&,T&&>
+  constexpr sender auto operator()(S&& s, T&& tp) const noexcept(noexcept(std::forward<S>(s).schedule_at(std::forward<T>(tp))))
+  {
+    return std::forward<S>(s).schedule_at(std::forward<T>(tp));
+  }
+
+  template<class S, class T>
+    requires (!has_schedule_at_member_function<S&&,T&&> and has_schedule_at_free_function<S&&,T&&>)
+  constexpr sender auto operator()(S&& s, T&& tp) const noexcept(noexcept(schedule_at(std::forward<S>(s), std::forward<T>(tp))))
+  {
+    return schedule_at(std::forward<S>(s), std::forward<T>(tp));
+  }
+};
+
+
+} // end detail
+
+
+constexpr detail::schedule_at_t schedule_at{};
+
+
+namespace detail
+{
+
+
+template<class S>
+concept has_now_member_function = requires(S&& s) { std::forward<S>(s).now(); };
+
+template<class S, class D>
+concept has_schedule_after_member_function = requires(S&& s, D&& d) { std::forward<S>(s).schedule_after(std::forward<D>(d)); };
+
+template<class S, class D>
+concept has_schedule_after_free_function = requires(S&& s, D&& d) { schedule_after(std::forward<S>(s), std::forward<D>(d)); };
+
+struct schedule_after_t
+{
+  template<class S, class D>
+    requires has_schedule_after_member_function<S&&,D&&>
+  constexpr sender auto operator()(S&& s, D&& d) const noexcept(noexcept(std::forward<S>(s).schedule_after(std::forward<D>(d))))
+  {
+    return std::forward<S>(s).schedule_after(std::forward<D>(d));
+  }
+
+  template<class S, class D>
+    requires (!has_schedule_after_member_function<S&&,D&&> and has_schedule_after_free_function<S&&,D&&>)
+  constexpr sender auto operator()(S&& s, D&& d) const noexcept(noexcept(schedule_after(std::forward<S>(s), std::forward<D>(d))))
+  {
+    return schedule_after(std::forward<S>(s), std::forward<D>(d));
+  }
+
+  // the default implementation schedules at the scheduler's notion of now plus the duration
+  template<class S, class D>
+    requires (!has_schedule_after_member_function<S&&,D&&> and
+              !has_schedule_after_free_function<S&&,D&&> and
+              has_now_member_function<S&&> and
+              requires(S&& s, D&& d) { execution::schedule_at(std::forward<S>(s), s.now() + std::forward<D>(d)); }
+             )
+  constexpr sender auto operator()(S&& s, D&& d) const
+  {
+    auto tp = s.now() + std::forward<D>(d);
+    return execution::schedule_at(std::forward<S>(s), tp);
+  }
+};
+
+
+} // end detail
+
+
+constexpr detail::schedule_after_t schedule_after{};
+
+
+namespace detail
+{
+
+
+template<class S, class P>
+concept has_with_priority_member_function = requires(S&& s, P&& p) { std::forward<S>(s).with_priority(std::forward<P>(p)); };
+
+template<class S, class P>
+concept has_with_priority_free_function = requires(S&& s, P&& p) { with_priority(std::forward<S>(s), std::forward<P>(p)); };
+
+struct with_priority_t
+{
+  template<class S, class P>
+    requires has_with_priority_member_function<S&&,P&&>
+  constexpr scheduler auto operator()(S&& s, P&& p) const noexcept(noexcept(std::forward<S>(s).with_priority(std::forward<P>(p))))
+  {
+    return std::forward<S>(s).with_priority(std::forward<P>(p));
+  }
+
+  template<class S, class P>
+    requires (!has_with_priority_member_function<S&&,P&&> and has_with_priority_free_function<S&&,P&&>)
+  constexpr scheduler auto operator()(S&& s, P&& p) const noexcept(noexcept(with_priority(std::forward<S>(s), std::forward<P>(p))))
+  {
+    return with_priority(std::forward<S>(s), std::forward<P>(p));
+  }
+
+  // a scheduler without a notion of priority schedules all work alike
+  template<scheduler S, class P>
+    requires (!has_with_priority_member_function<S&&,P&&> and !has_with_priority_free_function<S&&,P&&>)
+  constexpr remove_cvref_t<S> operator()(S&& s, P&&) const
+  {
+    return std::forward<S>(s);
+  }
+};
+
+
+} // end detail
+
+
+// with_priority returns a scheduler like s whose work is scheduled with priority p
+constexpr detail::with_priority_t with_priority{};
+
+
+namespace detail
+{
+
+
+template<class S, class... Args>
+concept has_async_read_member_function = requires(S&& s, Args&&... args) { std::forward<S>(s).async_read(std::forward<Args>(args)...); };
+
+template<class S, class... Args>
+concept has_async_read_free_function = requires(S&& s, Args&&... args) { async_read(std::forward<S>(s), std::forward<Args>(args)...); };
+
+struct async_read_t
+{
+  template<class S, class... Args>
+    requires has_async_read_member_function<S&&,Args&&...>
+  constexpr sender auto operator()(S&& s, Args&&... args) const noexcept(noexcept(std::forward<S>(s).async_read(std::forward<Args>(args)...)))
+  {
+    return std::forward<S>(s).async_read(std::forward<Args>(args)...);
+  }
+
+  template<class S, class... Args>
+    requires (!has_async_read_member_function<S&&,Args&&...> and has_async_read_free_function<S&&,Args&&...>)
+  constexpr sender auto operator()(S&& s, Args&&... args) const noexcept(noexcept(async_read(std::forward<S>(s), std::forward<Args>(args)...)))
+  {
+    return async_read(std::forward<S>(s), std::forward<Args>(args)...);
+  }
+};
+
+
+} // end detail
+
+
+// async_read(sched, fd, buffer[, offset]) returns a sender of the number of bytes read from fd into buffer
+constexpr detail::async_read_t async_read{};
+
+
+namespace detail
+{
+
+
+template<class S, class... Args>
+concept has_async_write_member_function = requires(S&& s, Args&&... args) { std::forward<S>(s).async_write(std::forward<Args>(args)...); };
+
+template<class S, class... Args>
+concept has_async_write_free_function = requires(S&& s, Args&&... args) { async_write(std::forward<S>(s), std::forward<Args>(args)...); };
+
+struct async_write_t
+{
+  template<class S, class... Args>
+    requires has_async_write_member_function<S&&,Args&&...>
+  constexpr sender auto operator()(S&& s, Args&&... args) const noexcept(noexcept(std::forward<S>(s).async_write(std::forward<Args>(args)...)))
+  {
+    return std::forward<S>(s).async_write(std::forward<Args>(args)...);
+  }
+
+  template<class S, class... Args>
+    requires (!has_async_write_member_function<S&&,Args&&...> and has_async_write_free_function<S&&,Args&&...>)
+  constexpr sender auto operator()(S&& s, Args&&... args) const noexcept(noexcept(async_write(std::forward<S>(s), std::forward<Args>(args)...)))
+  {
+    return async_write(std::forward<S>(s), std::forward<Args>(args)...);
+  }
+};
+
+
+} // end detail
+
+
+// async_write(sched, fd, buffer[, offset]) returns a sender of the number of bytes written to fd from buffer
+constexpr detail::async_write_t async_write{};
+
+
+namespace detail
+{
+
+
+template<class S, class... Args>
+concept has_async_accept_member_function = requires(S&& s, Args&&... args) { std::forward<S>(s).async_accept(std::forward<Args>(args)...); };
+
+template<class S, class... Args>
+concept has_async_accept_free_function = requires(S&& s, Args&&... args) { async_accept(std::forward<S>(s), std::forward<Args>(args)...); };
+
+struct async_accept_t
+{
+  template<class S, class... Args>
+    requires has_async_accept_member_function<S&&,Args&&...>
+  constexpr sender auto operator()(S&& s, Args&&... args) const noexcept(noexcept(std::forward<S>(s).async_accept(std::forward<Args>(args)...)))
+  {
+    return std::forward<S>(s).async_accept(std::forward<Args>(args)...);
+  }
+
+  template<class S, class... Args>
+    requires (!has_async_accept_member_function<S&&,Args&&...> and has_async_accept_free_function<S&&,Args&&...>)
+  constexpr sender auto operator()(S&& s, Args&&... args) const noexcept(noexcept(async_accept(std::forward<S>(s), std::forward<Args>(args)...)))
+  {
+    return async_accept(std::forward<S>(s), std::forward<Args>(args)...);
+  }
+};
+
+
+} // end detail
+
+
+// async_accept(sched, fd) returns a sender of the descriptor of a connection accepted on the listening socket fd
+constexpr detail::async_accept_t async_accept{};
+
+
+namespace detail
+{
+
+
+// the number of chunks default bulk implementations partition an index space into
+inline std::size_t bulk_chunk_count(std::size_t n) noexcept
+{
+  std::size_t num_threads = std::thread::hardware_concurrency();
+  return std::min(n, num_threads ? num_threads : 1);
+}
+
+
+template<class E, class F, class N>
+concept has_bulk_execute_member_function = requires(E&& e, F&& f, N&& n) { std::forward<E>(e).bulk_execute(std::forward<F>(f), std::forward<N>(n)); };
+
+template<class E, class F, class N>
+concept has_bulk_execute_free_function = requires(E&& e, F&& f, N&& n) { bulk_execute(std::forward<E>(e), std::forward<F>(f), std::forward<N>(n)); };
+
+struct bulk_execute_t
+{
+  template<class E, class F, class N>
+    requires has_bulk_execute_member_function<E&&,F&&,N&&>
+  constexpr auto operator()(E&& e, F&& f, N&& n) const noexcept(noexcept(std::forward<E>(e).bulk_execute(std::forward<F>(f), std::forward<N>(n))))
+  {
+    return std::forward<E>(e).bulk_execute(std::forward<F>(f), std::forward<N>(n));
+  }
+
+  template<class E, class F, class N>
+    requires (!has_bulk_execute_member_function<E&&,F&&,N&&> and has_bulk_execute_free_function<E&&,F&&,N&&>)
+  constexpr auto operator()(E&& e, F&& f, N&& n) const noexcept(noexcept(bulk_execute(std::forward<E>(e), std::forward<F>(f), std::forward<N>(n))))
+  {
+    return bulk_execute(std::forward<E>(e), std::forward<F>(f), std::forward<N>(n));
+  }
+
+  // the default implementation partitions [0, n) into bulk_chunk_count(n) contiguous chunks
+  // and executes each chunk, along with a copy of f, as a single invocable
+  template<executor E, class F>
+    requires (!has_bulk_execute_member_function<E&&,F&&,std::size_t> and
+              !has_bulk_execute_free_function<E&&,F&&,std::size_t> and
+              invocable<remove_cvref_t<F>&, std::size_t> and
+              copy_constructible<remove_cvref_t<F>>
+             )
+  constexpr void operator()(E&& e, F&& f, std::size_t n) const
+  {
+    std::size_t num_chunks = bulk_chunk_count(n);
+
+    for(std::size_t chunk = 0; chunk < num_chunks; ++chunk)
+    {
+      std::size_t begin = chunk * n / num_chunks;
+      std::size_t end = (chunk + 1) * n / num_chunks;
+
+      execution::execute(e, [f,begin,end]() mutable
+      {
+        for(std::size_t i = begin; i < end; ++i)
+        {
+          std::invoke(f, i);
+        }
+      });
+    }
+  }
+};
+
+
+} // end detail
+
+
+constexpr detail::bulk_execute_t bulk_execute{};
+
+
+namespace detail
+{
+
+
+// bulk_sender is a sender of void which, when started, invokes f(i) for each i in [0, n)
+// on its executor and completes its receiver once every invocation has returned
+//
+// the first exception thrown by f is delivered through set_error. without exceptions, f must not throw
+template<class E, class F>
+class bulk_sender
+{
+  private:
+    E ex_;
+    F f_;
+    std::size_t n_;
+
+  public:
+    template<template<class...> class Tuple, template<class...> class Variant>
+    using value_types = Variant<Tuple<>>;
+
+    template<template<class...> class Variant>
+    using error_types = Variant<error_type>;
+
+    static constexpr bool sends_done = true;
+
+    bulk_sender(E ex, F f, std::size_t n)
+      : ex_(ex), f_(std::move(f)), n_(n)
+    {}
+
+    template<receiver_of R>
+    struct operation
+    {
+      E ex_;
+      F f_;
+      std::size_t n_;
+      remove_cvref_t<R> r_;
+      std::atomic<std::size_t> remaining_;
+      std::atomic<bool> has_error_;
+      error_type error_;
+
+      template<class OtherF, class OtherR>
+      operation(E ex, OtherF&& f, std::size_t n, OtherR&& r)
+        : ex_(ex),
+          f_(std::forward<OtherF>(f)),
+          n_(n),
+          r_(std::forward<OtherR>(r)),
+          remaining_(0),
+          has_error_(false)
+      {}
+
+      // executing chunks refer to this object, so it must not move
+      operation(operation&&) = delete;
+
+      struct chunk_function
+      {
+        operation* op_;
+        std::size_t num_chunks_;
+
+        void operator()(std::size_t chunk) const noexcept
+        {
+          std::size_t begin = chunk * op_->n_ / num_chunks_;
+          std::size_t end = (chunk + 1) * op_->n_ / num_chunks_;
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+          for(std::size_t i = begin; i < end; ++i)
+          {
+            std::invoke(op_->f_, i);
+          }
+#else
+          try
+          {
+            for(std::size_t i = begin; i < end; ++i)
+            {
+              std::invoke(op_->f_, i);
+            }
+          }
+          catch(...)
+          {
+            op_->record_error(std::current_exception());
+          }
+#endif
+
+          op_->finish(1);
+        }
+      };
+
+      // only the first error is delivered
+      void record_error(error_type e) noexcept
+      {
+        if(!has_error_.exchange(true))
+        {
+          error_ = std::move(e);
+        }
+      }
+
+      // releases num_chunks counts of remaining_, and completes the receiver with the last
+      void finish(std::size_t num_chunks) noexcept
+      {
+        if(remaining_.fetch_sub(num_chunks, std::memory_order_acq_rel) == num_chunks)
+        {
+          complete();
+        }
+      }
+
+      void complete() noexcept
+      {
+        if(has_error_.load(std::memory_order_relaxed))
+        {
+          execution::set_error(std::move(r_), std::move(error_));
+          return;
+        }
+
+        detail::set_value_or_error(std::move(r_));
+      }
+
+      void start() noexcept
+      {
+        if(n_ == 0)
+        {
+          complete();
+          return;
+        }
+
+        std::size_t num_chunks = bulk_chunk_count(n_);
+
+        // start holds a count of its own, so that chunks which finish while others are still
+        // being dispatched cannot complete the operation before dispatch has stopped touching it
+        remaining_.store(num_chunks + 1, std::memory_order_relaxed);
+
+        std::size_t num_dispatched = 0;
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+        dispatch(num_chunks, num_dispatched);
+#else
+        try
+        {
+          dispatch(num_chunks, num_dispatched);
+        }
+        catch(...)
+        {
+          record_error(std::current_exception());
+        }
+#endif
+
+        // chunks which were never dispatched will never finish, so start releases their counts with its own
+        finish(num_chunks - num_dispatched + 1);
+      }
+
+      // counts the chunks dispatched, all of which will run, in num_dispatched
+      //
+      // a native bulk_execute must either dispatch every chunk or throw having dispatched none. otherwise,
+      // chunks are executed one at a time, so that if execute throws, the chunks already executed are known
+      void dispatch(std::size_t num_chunks, std::size_t& num_dispatched)
+      {
+        if constexpr(has_bulk_execute_member_function<E&, chunk_function, std::size_t> or
+                     has_bulk_execute_free_function<E&, chunk_function, std::size_t>)
+        {
+          execution::bulk_execute(ex_, chunk_function{this, num_chunks}, num_chunks);
+          num_dispatched = num_chunks;
+        }
+        else
+        {
+          for(; num_dispatched < num_chunks; ++num_dispatched)
+          {
+            execution::execute(ex_, [f = chunk_function{this, num_chunks}, chunk = num_dispatched]{ f(chunk); });
+          }
+        }
+      }
+    };
+
+    template<receiver_of R>
+    operation<R> connect(R&& r) &&
+    {
+      return {ex_, std::move(f_), n_, std::forward<R>(r)};
+    }
+
+    template<receiver_of R>
+    operation<R> connect(R&& r) const &
+    {
+      return {ex_, f_, n_, std::forward<R>(r)};
+    }
+};
+
+
+template<class E, class N, class F>
+concept has_bulk_schedule_member_function = requires(E&& e, N&& n, F&& f) { std::forward<E>(e).bulk_schedule(std::forward<N>(n), std::forward<F>(f)); };
+
+template<class E, class N, class F>
+concept has_bulk_schedule_free_function = requires(E&& e, N&& n, F&& f) { bulk_schedule(std::forward<E>(e), std::forward<N>(n), std::forward<F>(f)); };
+
+struct bulk_schedule_t
+{
+  template<class E, class N, class F>
+    requires has_bulk_schedule_member_function<E&&,N&&,F&&>
+  constexpr sender auto operator()(E&& e, N&& n, F&& f) const noexcept(noexcept(std::forward<E>(e).bulk_schedule(std::forward<N>(n), std::forward<F>(f))))
+  {
+    return std::forward<E>(e).bulk_schedule(std::forward<N>(n), std::forward<F>(f));
+  }
+
+  template<class E, class N, class F>
+    requires (!has_bulk_schedule_member_function<E&&,N&&,F&&> and has_bulk_schedule_free_function<E&&,N&&,F&&>)
+  constexpr sender auto operator()(E&& e, N&& n, F&& f) const noexcept(noexcept(bulk_schedule(std::forward<E>(e), std::forward<N>(n), std::forward<F>(f))))
+  {
+    return bulk_schedule(std::forward<E>(e), std::forward<N>(n), std::forward<F>(f));
+  }
+
+  template<executor E, class F>
+    requires (!has_bulk_schedule_member_function<E&&,std::size_t,F&&> and
+              !has_bulk_schedule_free_function<E&&,std::size_t,F&&> and
+              invocable<remove_cvref_t<F>&, std::size_t>
+             )
+  constexpr sender auto operator()(E&& e, std::size_t n, F&& f) const
+  {
+    return bulk_sender<remove_cvref_t<E>, remove_cvref_t<F>>{std::forward<E>(e), std::forward<F>(f), n};
+  }
+};
+
+
+} // end detail
+
+
+constexpr detail::bulk_schedule_t bulk_schedule{};
+
+
+namespace detail
+{
+
+
+// the type of the elements of a range
+template<class Rs>
+using range_value_t = remove_cvref_t<decltype(*std::begin(std::declval<Rs&>()))>;
+
+
+template<class S, class Rs>
+concept has_submit_batch_member_function = requires(S&& s, Rs&& rs) { std::forward<S>(s).submit_batch(std::forward<Rs>(rs)); };
+
+template<class S, class Rs>
+concept has_submit_batch_free_function = requires(S&& s, Rs&& rs) { submit_batch(std::forward<S>(s), std::forward<Rs>(rs)); };
+
+struct submit_batch_t
+{
+  template<class S, class Rs>
+    requires has_submit_batch_member_function<S&&,Rs&&>
+  constexpr auto operator()(S&& s, Rs&& receivers) const noexcept(noexcept(std::forward<S>(s).submit_batch(std::forward<Rs>(receivers))))
+  {
+    return std::forward<S>(s).submit_batch(std::forward<Rs>(receivers));
+  }
+
+  template<class S, class Rs>
+    requires (!has_submit_batch_member_function<S&&,Rs&&> and has_submit_batch_free_function<S&&,Rs&&>)
+  constexpr auto operator()(S&& s, Rs&& receivers) const noexcept(noexcept(submit_batch(std::forward<S>(s), std::forward<Rs>(receivers))))
+  {
+    return submit_batch(std::forward<S>(s), std::forward<Rs>(receivers));
+  }
+
+  template<class S, class Rs>
+    requires (!has_submit_batch_member_function<S&&,Rs&&> and
+              !has_submit_batch_free_function<S&&,Rs&&> and
+              sender_to<S&, range_value_t<Rs>>
+             )
+  constexpr void operator()(S&& s, Rs&& receivers) const
+  {
+    for(auto& r : receivers)
+    {
+      execution::submit(s, std::move(r));
+    }
+  }
+};
+
+
+} // end detail
+
+
+// submit_batch submits each receiver of a range to the same sender, moving it out of the range
+// contexts customize submit_batch to enqueue every resulting operation in a single transaction
+constexpr detail::submit_batch_t submit_batch{};
+
+
+namespace detail
+{
+
+
+template<class E, class Fs>
+concept has_execute_batch_member_function = requires(E&& e, Fs&& fs) { std::forward<E>(e).execute_batch(std::forward<Fs>(fs)); };
+
+template<class E, class Fs>
+concept has_execute_batch_free_function = requires(E&& e, Fs&& fs) { execute_batch(std::forward<E>(e), std::forward<Fs>(fs)); };
+
+struct execute_batch_t
+{
+  template<class E, class Fs>
+    requires has_execute_batch_member_function<E&&,Fs&&>
+  constexpr auto operator()(E&& e, Fs&& fs) const noexcept(noexcept(std::forward<E>(e).execute_batch(std::forward<Fs>(fs))))
+  {
+    return std::forward<E>(e).execute_batch(std::forward<Fs>(fs));
+  }
+
+  template<class E, class Fs>
+    requires (!has_execute_batch_member_function<E&&,Fs&&> and has_execute_batch_free_function<E&&,Fs&&>)
+  constexpr auto operator()(E&& e, Fs&& fs) const noexcept(noexcept(execute_batch(std::forward<E>(e), std::forward<Fs>(fs))))
+  {
+    return execute_batch(std::forward<E>(e), std::forward<Fs>(fs));
+  }
+
+  template<executor E, class Fs>
+    requires (!has_execute_batch_member_function<E&&,Fs&&> and
+              !has_execute_batch_free_function<E&&,Fs&&> and
+              invocable<range_value_t<Fs>&>
+             )
+  constexpr void operator()(E&& e, Fs&& fs) const
+  {
+    for(auto& f : fs)
+    {
+      execution::execute(e, std::move(f));
+    }
+  }
+};
+
+
+} // end detail
+
+
+// execute_batch executes each invocable of a range on the same executor, moving it out of the range
+constexpr detail::execute_batch_t execute_batch{};
+
+
 } // end execution
 
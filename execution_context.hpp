@@ -0,0 +1,111 @@
+#pragma once
+
+#include "execution.hpp"
+#include <utility>
+
+
+struct execution_context
+{
+  template<class F>
+    requires invocable<F&>
+  void execute_invocable(F f) const
+  {
+    std::invoke(f);
+  }
+
+  template<execution::receiver_of R>
+  void submit_receiver(R&& r) const
+  {
+    execution::detail::set_value_or_error(std::move(r));
+  }
+
+
+  struct executor_type
+  {
+    const execution_context& context_;
+
+    template<class F>
+      requires invocable<F&>
+    void execute(F&& f) const
+    {
+      context_.execute_invocable(std::forward<F>(f));
+    }
+
+    friend bool operator==(const executor_type& a, const executor_type& b)
+    {
+      return &a.context_ == &b.context_;
+    }
+
+    friend bool operator!=(const executor_type& a, const executor_type& b)
+    {
+      return !(a == b);
+    }
+  };
+
+  executor_type executor() const
+  {
+    return {*this};
+  }
+
+
+  struct scheduler_type
+  {
+    const execution_context& context_;
+
+    struct sender_type
+    {
+      template<template<class...> class Tuple, template<class...> class Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template<template<class...> class Variant>
+      using error_types = Variant<execution::error_type>;
+
+      static constexpr bool sends_done = true;
+
+      const execution_context& context_;
+
+      template<execution::receiver_of R> 
+      struct operation
+      {
+        const execution_context& context_;
+        remove_cvref_t<R> receiver_;
+
+        void start() noexcept
+        {
+          context_.submit_receiver(std::move(receiver_));
+        }
+      };
+
+      template<execution::receiver_of R>
+      operation<R> connect(R&& r) const
+      {
+        return {context_, std::forward<R>(r)};
+      }
+    };
+
+    sender_type schedule() const
+    {
+      return {context_};
+    }
+
+    friend bool operator==(const scheduler_type& a, const scheduler_type& b)
+    {
+      return &a.context_ == &b.context_;
+    }
+
+    friend bool operator!=(const scheduler_type& a, const scheduler_type& b)
+    {
+      return !(a == b);
+    }
+  };
+
+  scheduler_type scheduler() const
+  {
+    return {*this};
+  }
+};
+
+
+template<>
+struct execution::is_inline_executor<execution_context::executor_type> : std::true_type {};
+
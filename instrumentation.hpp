@@ -0,0 +1,582 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "execution.hpp"
+#include <functional>
+#include <new>
+#include <thread>
+#include <utility>
+
+
+// instrumentation measures an executor's behavior: the time work waits between being enqueued and
+// starting, the time it runs, the depth of the executor's queue when it is enqueued, and the path
+// through which it arrived
+//
+// instrument(ex, stats) wraps ex in an instrumented_executor, which records into stats. each thread
+// records into its own shard of stats with plain relaxed stores, so recording takes no locks and
+// contends on nothing but the queue depth counter. snapshot() merges the shards, and may be called
+// at any time from any thread
+//
+// instrumentation is compiled only when EXECUTION_INSTRUMENTATION is defined. otherwise, instrument(ex, stats)
+// returns ex itself, and instrumented code compiles to exactly what it would without instrumentation
+
+
+namespace detail
+{
+
+
+// histograms are log-linear, in the style of HdrHistogram: values are bucketed by their most significant bit,
+// and then linearly by the histogram_sub_bucket_bits bits which follow it, bounding the relative error to 1/16
+inline constexpr std::size_t histogram_sub_bucket_bits = 4;
+inline constexpr std::size_t histogram_sub_buckets = std::size_t(1) << histogram_sub_bucket_bits;
+inline constexpr std::size_t histogram_num_buckets = (64 - histogram_sub_bucket_bits + 1) * histogram_sub_buckets;
+
+
+constexpr std::size_t histogram_bucket(std::uint64_t value) noexcept
+{
+  if(value < 2 * histogram_sub_buckets)
+  {
+    return value;
+  }
+
+  std::size_t shift = std::bit_width(value) - 1 - histogram_sub_bucket_bits;
+
+  return (shift + 1) * histogram_sub_buckets + ((value >> shift) & (histogram_sub_buckets - 1));
+}
+
+
+// the smallest value which falls into bucket, or 0 after the last bucket
+constexpr std::uint64_t histogram_bucket_lower_bound(std::size_t bucket) noexcept
+{
+  if(bucket < 2 * histogram_sub_buckets)
+  {
+    return bucket;
+  }
+
+  std::size_t shift = bucket / histogram_sub_buckets - 1;
+
+  return (histogram_sub_buckets + bucket % histogram_sub_buckets) << shift;
+}
+
+
+// increments a counter which only the calling thread writes
+inline void increment_owned(std::atomic<std::uint64_t>& counter) noexcept
+{
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+} // end detail
+
+
+// histogram is a snapshot of the values recorded into one of executor_stats' histograms
+class histogram
+{
+  public:
+    void add(std::size_t bucket, std::uint64_t count) noexcept
+    {
+      counts_[bucket] += count;
+      count_ += count;
+    }
+
+    std::uint64_t count() const noexcept
+    {
+      return count_;
+    }
+
+    // the value below which fraction p of the recorded values fall, to within the histogram's precision
+    std::uint64_t percentile(double p) const noexcept
+    {
+      std::uint64_t rank = static_cast<std::uint64_t>(p * count_);
+      std::uint64_t seen = 0;
+
+      for(std::size_t bucket = 0; bucket < counts_.size(); ++bucket)
+      {
+        seen += counts_[bucket];
+
+        if(seen > rank)
+        {
+          // the largest value the bucket holds
+          return detail::histogram_bucket_lower_bound(bucket + 1) - 1;
+        }
+      }
+
+      return max();
+    }
+
+    std::uint64_t max() const noexcept
+    {
+      for(std::size_t bucket = counts_.size(); bucket > 0; --bucket)
+      {
+        if(counts_[bucket - 1])
+        {
+          return detail::histogram_bucket_lower_bound(bucket) - 1;
+        }
+      }
+
+      return 0;
+    }
+
+  private:
+    std::array<std::uint64_t, detail::histogram_num_buckets> counts_{};
+    std::uint64_t count_ = 0;
+};
+
+
+// executor_stats accumulates what instrumented_executors record
+// it must outlive the executors recording into it and the work they create
+class executor_stats
+{
+  public:
+    // the paths through which work reaches an executor
+    enum class path : std::size_t
+    {
+      // execute with a nullary invocable
+      invocable,
+
+      // execute with the invocable connect's executor fallback adapts a receiver into
+      as_invocable,
+
+      // connect(schedule(ex), r) with the caller's receiver
+      receiver,
+
+      // connect(schedule(ex), r) with the receiver of submit's fallback, which heap-allocates the operation
+      submit_receiver
+    };
+
+    static constexpr std::size_t num_paths = 4;
+
+    struct snapshot_type
+    {
+      // nanoseconds between work being enqueued and starting
+      histogram dispatch_latency_;
+
+      // nanoseconds work spent running, including the completion of the receiver it started
+      histogram run_time_;
+
+      // the number of items enqueued but not yet started, sampled as each is enqueued
+      histogram queue_depth_;
+
+      std::uint64_t current_queue_depth_;
+
+      // indexed by path
+      std::array<std::uint64_t, num_paths> num_enqueued_;
+    };
+
+    executor_stats() noexcept
+      : id_(next_id()),
+        shards_(nullptr),
+        queue_depth_(0)
+    {}
+
+    executor_stats(const executor_stats&) = delete;
+
+    ~executor_stats()
+    {
+      shard* s = shards_.load(std::memory_order_acquire);
+
+      while(s)
+      {
+        delete std::exchange(s, s->next_);
+      }
+    }
+
+    snapshot_type snapshot() const noexcept
+    {
+      snapshot_type result{};
+
+      for(const shard* s = shards_.load(std::memory_order_acquire); s; s = s->next_)
+      {
+        for(std::size_t bucket = 0; bucket < detail::histogram_num_buckets; ++bucket)
+        {
+          result.dispatch_latency_.add(bucket, s->dispatch_latency_[bucket].load(std::memory_order_relaxed));
+          result.run_time_.add(bucket, s->run_time_[bucket].load(std::memory_order_relaxed));
+          result.queue_depth_.add(bucket, s->queue_depth_[bucket].load(std::memory_order_relaxed));
+        }
+
+        for(std::size_t p = 0; p < num_paths; ++p)
+        {
+          result.num_enqueued_[p] += s->num_enqueued_[p].load(std::memory_order_relaxed);
+        }
+      }
+
+      std::int64_t depth = queue_depth_.load(std::memory_order_relaxed);
+      result.current_queue_depth_ = depth < 0 ? 0 : depth;
+
+      return result;
+    }
+
+    // records work entering the executor through p and returns the time it did so
+    std::uint64_t enqueued(path p) noexcept
+    {
+      std::int64_t depth = queue_depth_.fetch_add(1, std::memory_order_relaxed);
+
+      if(shard* s = local_shard())
+      {
+        detail::increment_owned(s->num_enqueued_[static_cast<std::size_t>(p)]);
+        detail::increment_owned(s->queue_depth_[detail::histogram_bucket(depth < 0 ? 0 : depth)]);
+      }
+
+      return now();
+    }
+
+    // records work enqueued at enqueued_at starting and returns the time it did so
+    std::uint64_t started(std::uint64_t enqueued_at) noexcept
+    {
+      queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+
+      std::uint64_t result = now();
+
+      if(shard* s = local_shard())
+      {
+        detail::increment_owned(s->dispatch_latency_[detail::histogram_bucket(result - enqueued_at)]);
+      }
+
+      return result;
+    }
+
+    // records work started at started_at finishing
+    void finished(std::uint64_t started_at) noexcept
+    {
+      std::uint64_t elapsed = now() - started_at;
+
+      if(shard* s = local_shard())
+      {
+        detail::increment_owned(s->run_time_[detail::histogram_bucket(elapsed)]);
+      }
+    }
+
+    // records enqueued work being destroyed without starting
+    void discarded() noexcept
+    {
+      queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+  private:
+    using buckets = std::array<std::atomic<std::uint64_t>, detail::histogram_num_buckets>;
+
+    // the counters written by a single thread
+    struct shard
+    {
+      std::thread::id owner_;
+      shard* next_;
+
+      buckets dispatch_latency_{};
+      buckets run_time_{};
+      buckets queue_depth_{};
+      std::array<std::atomic<std::uint64_t>, num_paths> num_enqueued_{};
+    };
+
+    static std::uint64_t next_id() noexcept
+    {
+      static std::atomic<std::uint64_t> result{1};
+      return result.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static std::uint64_t now() noexcept
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // returns the calling thread's shard, or null if one could not be allocated
+    shard* local_shard() noexcept
+    {
+      // a small cache of the shards this thread recently used, keyed by stats id
+      // ids are never reused, so an entry outliving its executor_stats is never matched again
+      struct cache_entry
+      {
+        std::uint64_t id_;
+        shard* shard_;
+      };
+
+      thread_local std::array<cache_entry, 8> cache{};
+
+      cache_entry& entry = cache[id_ % cache.size()];
+
+      if(entry.id_ == id_)
+      {
+        return entry.shard_;
+      }
+
+      std::thread::id this_thread = std::this_thread::get_id();
+      shard* result = shards_.load(std::memory_order_acquire);
+
+      while(result and result->owner_ != this_thread)
+      {
+        result = result->next_;
+      }
+
+      if(not result)
+      {
+        result = new(std::nothrow) shard{this_thread, shards_.load(std::memory_order_relaxed)};
+
+        if(not result)
+        {
+          return nullptr;
+        }
+
+        while(not shards_.compare_exchange_weak(result->next_, result, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+      }
+
+      entry = {id_, result};
+      return result;
+    }
+
+    const std::uint64_t id_;
+    std::atomic<shard*> shards_;
+    std::atomic<std::int64_t> queue_depth_;
+};
+
+
+#if defined(EXECUTION_INSTRUMENTATION)
+
+
+namespace detail
+{
+
+
+struct finish_on_exit
+{
+  executor_stats* stats_;
+  std::uint64_t started_at_;
+
+  ~finish_on_exit()
+  {
+    stats_->finished(started_at_);
+  }
+};
+
+
+template<class F>
+class instrumented_invocable
+{
+  public:
+    template<class OtherF>
+    instrumented_invocable(OtherF&& f, executor_stats& stats, executor_stats::path p)
+      : f_(std::forward<OtherF>(f)),
+        stats_(&stats),
+        enqueued_at_(stats.enqueued(p))
+    {}
+
+    instrumented_invocable(instrumented_invocable&& other) noexcept(std::is_nothrow_move_constructible_v<F>)
+      : f_(std::move(other.f_)),
+        stats_(std::exchange(other.stats_, nullptr)),
+        enqueued_at_(other.enqueued_at_)
+    {}
+
+    ~instrumented_invocable()
+    {
+      if(stats_)
+      {
+        stats_->discarded();
+      }
+    }
+
+    void operator()() &
+    {
+      executor_stats* stats = std::exchange(stats_, nullptr);
+      finish_on_exit finish{stats, stats->started(enqueued_at_)};
+
+      std::invoke(f_);
+    }
+
+  private:
+    F f_;
+    executor_stats* stats_;
+    std::uint64_t enqueued_at_;
+};
+
+
+template<class R>
+struct instrumented_receiver
+{
+  R r_;
+  executor_stats* stats_;
+  const std::uint64_t* enqueued_at_;
+
+  template<class... As>
+    requires execution::receiver_of<R, As...>
+  void set_value(As&&... as) && noexcept(execution::is_nothrow_receiver_of_v<R, As...>)
+  {
+    finish_on_exit finish{stats_, stats_->started(*enqueued_at_)};
+
+    execution::set_value(std::move(r_), std::forward<As>(as)...);
+  }
+
+  template<class E>
+    requires execution::receiver<R,E>
+  void set_error(E&& e) && noexcept
+  {
+    stats_->started(*enqueued_at_);
+    execution::set_error(std::move(r_), std::forward<E>(e));
+  }
+
+  void set_done() && noexcept
+  {
+    stats_->started(*enqueued_at_);
+    execution::set_done(std::move(r_));
+  }
+
+  auto get_stop_token() const noexcept
+  {
+    return execution::get_stop_token(r_);
+  }
+
+  auto get_allocator() const noexcept
+  {
+    return execution::get_allocator(r_);
+  }
+};
+
+
+template<class S, class R>
+class instrumented_operation
+{
+  public:
+    template<class OtherS, class OtherR>
+    instrumented_operation(OtherS&& s, OtherR&& r, executor_stats* stats)
+      : stats_(stats),
+        op_(execution::connect(std::forward<OtherS>(s), instrumented_receiver<R>{std::forward<OtherR>(r), stats, &enqueued_at_}))
+    {}
+
+    // op_'s receiver refers to enqueued_at_, so this object must not move
+    instrumented_operation(instrumented_operation&&) = delete;
+
+    void start() noexcept
+    {
+      constexpr executor_stats::path p = execution::detail::is_submit_receiver_v<R> ?
+        executor_stats::path::submit_receiver :
+        executor_stats::path::receiver
+      ;
+
+      enqueued_at_ = stats_->enqueued(p);
+      execution::start(op_);
+    }
+
+  private:
+    executor_stats* stats_;
+    std::uint64_t enqueued_at_;
+    execution::connect_result_t<S, instrumented_receiver<R>> op_;
+};
+
+
+template<class S>
+struct instrumented_sender
+{
+  template<template<class...> class Tuple, template<class...> class Variant>
+  using value_types = typename execution::sender_traits<S>::template value_types<Tuple, Variant>;
+
+  template<template<class...> class Variant>
+  using error_types = typename execution::sender_traits<S>::template error_types<Variant>;
+
+  static constexpr bool sends_done = execution::sender_traits<S>::sends_done;
+
+  S sender_;
+  executor_stats* stats_;
+
+  template<execution::receiver R>
+  instrumented_operation<S, remove_cvref_t<R>> connect(R&& r) &&
+  {
+    return {std::move(sender_), std::forward<R>(r), stats_};
+  }
+
+  template<execution::receiver R>
+  instrumented_operation<const S&, remove_cvref_t<R>> connect(R&& r) const &
+  {
+    return {sender_, std::forward<R>(r), stats_};
+  }
+};
+
+
+} // end detail
+
+
+// instrumented_executor forwards work to Executor, recording its progress into an executor_stats
+template<class Executor>
+class instrumented_executor
+{
+  public:
+    instrumented_executor(const Executor& ex, executor_stats& stats) noexcept
+      : ex_(ex),
+        stats_(&stats)
+    {}
+
+    const Executor& base() const noexcept
+    {
+      return ex_;
+    }
+
+    template<class F>
+      requires invocable<remove_cvref_t<F>&>
+    void execute(F&& f) const
+    {
+      constexpr executor_stats::path p = execution::detail::is_as_invocable_v<remove_cvref_t<F>> ?
+        executor_stats::path::as_invocable :
+        executor_stats::path::invocable
+      ;
+
+      execution::execute(ex_, detail::instrumented_invocable<remove_cvref_t<F>>{std::forward<F>(f), *stats_, p});
+    }
+
+    // only executors with a native schedule are instrumented as schedulers. the rest are adapted
+    // by execution::schedule's fallback, whose work arrives through execute as an as_invocable
+    auto schedule() const
+      requires execution::detail::has_schedule_member_function<const Executor&> or
+               execution::detail::has_schedule_free_function<const Executor&>
+    {
+      using sender_type = remove_cvref_t<decltype(execution::schedule(ex_))>;
+
+      return detail::instrumented_sender<sender_type>{execution::schedule(ex_), stats_};
+    }
+
+    template<class P>
+      requires requires(const Executor& ex, P&& p) { execution::with_priority(ex, std::forward<P>(p)); }
+    auto with_priority(P&& p) const
+    {
+      using executor_type = remove_cvref_t<decltype(execution::with_priority(ex_, std::forward<P>(p)))>;
+
+      return instrumented_executor<executor_type>{execution::with_priority(ex_, std::forward<P>(p)), *stats_};
+    }
+
+    friend bool operator==(const instrumented_executor& a, const instrumented_executor& b)
+    {
+      return a.ex_ == b.ex_ and a.stats_ == b.stats_;
+    }
+
+    friend bool operator!=(const instrumented_executor& a, const instrumented_executor& b)
+    {
+      return !(a == b);
+    }
+
+  private:
+    Executor ex_;
+    executor_stats* stats_;
+};
+
+
+template<execution::executor Executor>
+instrumented_executor<Executor> instrument(const Executor& ex, executor_stats& stats) noexcept
+{
+  return {ex, stats};
+}
+
+
+#else
+
+
+// without EXECUTION_INSTRUMENTATION, nothing is recorded and ex is returned as is
+template<execution::executor Executor>
+Executor instrument(const Executor& ex, executor_stats&) noexcept
+{
+  return ex;
+}
+
+
+#endif
@@ -0,0 +1,361 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include "execution.hpp"
+#include <functional>
+#include <memory>
+#include <utility>
+
+
+namespace detail
+{
+
+
+// task_base is the intrusive hook embedded in everything a context can run
+// contexts never allocate to enqueue a task; they only link and unlink these hooks
+struct task_base
+{
+  void (*execute_)(task_base*) noexcept;
+  task_base* next_ = nullptr;
+
+  explicit task_base(void (*execute)(task_base*) noexcept) noexcept
+    : execute_(execute)
+  {}
+
+  void execute() noexcept
+  {
+    execute_(this);
+  }
+};
+
+
+// a non-synchronized FIFO of task_base
+class intrusive_queue
+{
+  public:
+    intrusive_queue() = default;
+
+    intrusive_queue(intrusive_queue&& other) noexcept
+      : head_(std::exchange(other.head_, nullptr)),
+        tail_(std::exchange(other.tail_, nullptr))
+    {}
+
+    intrusive_queue& operator=(intrusive_queue&& other) noexcept
+    {
+      head_ = std::exchange(other.head_, nullptr);
+      tail_ = std::exchange(other.tail_, nullptr);
+      return *this;
+    }
+
+    bool empty() const noexcept
+    {
+      return head_ == nullptr;
+    }
+
+    void push_back(task_base* task) noexcept
+    {
+      task->next_ = nullptr;
+
+      if(tail_)
+      {
+        tail_->next_ = task;
+      }
+      else
+      {
+        head_ = task;
+      }
+
+      tail_ = task;
+    }
+
+    void append(intrusive_queue&& other) noexcept
+    {
+      if(other.empty())
+      {
+        return;
+      }
+
+      if(tail_)
+      {
+        tail_->next_ = other.head_;
+      }
+      else
+      {
+        head_ = other.head_;
+      }
+
+      tail_ = other.tail_;
+      other.head_ = other.tail_ = nullptr;
+    }
+
+    task_base* pop_front() noexcept
+    {
+      task_base* result = head_;
+
+      if(result)
+      {
+        head_ = result->next_;
+
+        if(!head_)
+        {
+          tail_ = nullptr;
+        }
+      }
+
+      return result;
+    }
+
+    // adopts a list linked through next_ in reverse (LIFO) order
+    static intrusive_queue from_reversed_list(task_base* list) noexcept
+    {
+      intrusive_queue result;
+      result.tail_ = list;
+
+      while(list)
+      {
+        task_base* next = list->next_;
+        list->next_ = result.head_;
+        result.head_ = list;
+        list = next;
+      }
+
+      return result;
+    }
+
+  private:
+    task_base* head_ = nullptr;
+    task_base* tail_ = nullptr;
+};
+
+
+// a lock-free, multiple-producer single-consumer queue of task_base
+//
+// producers push onto an atomic stack with a single CAS; the consumer takes the whole stack
+// with one exchange and restores FIFO order, so draining costs one atomic operation per batch
+class atomic_intrusive_queue
+{
+  public:
+    // returns true if the queue was empty before task was pushed
+    bool push(task_base* task) noexcept
+    {
+      task_base* old_head = head_.load(std::memory_order_relaxed);
+
+      do
+      {
+        task->next_ = old_head;
+      }
+      while(!head_.compare_exchange_weak(old_head, task, std::memory_order_release, std::memory_order_relaxed));
+
+      return old_head == nullptr;
+    }
+
+    // pushes every task of tasks with a single CAS
+    // returns true if the queue was empty before tasks were pushed
+    bool push_all(intrusive_queue&& tasks) noexcept
+    {
+      // relink tasks into the stack's LIFO order
+      task_base* first = nullptr;
+      task_base* last = nullptr;
+
+      while(task_base* task = tasks.pop_front())
+      {
+        task->next_ = first;
+        first = task;
+
+        if(!last)
+        {
+          last = task;
+        }
+      }
+
+      if(!first)
+      {
+        return false;
+      }
+
+      task_base* old_head = head_.load(std::memory_order_relaxed);
+
+      do
+      {
+        last->next_ = old_head;
+      }
+      while(!head_.compare_exchange_weak(old_head, first, std::memory_order_release, std::memory_order_relaxed));
+
+      return old_head == nullptr;
+    }
+
+    // may miss concurrent pushes, but a queue the consumer finds non-empty stays so until it pops
+    bool empty() const noexcept
+    {
+      return head_.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    // only the consumer may call pop_all
+    intrusive_queue pop_all() noexcept
+    {
+      return intrusive_queue::from_reversed_list(head_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    // blocks the consumer until the queue is non-empty
+    void wait() const noexcept
+    {
+      head_.wait(nullptr, std::memory_order_acquire);
+    }
+
+    // wakes a consumer blocked in wait
+    void notify() noexcept
+    {
+      head_.notify_one();
+    }
+
+  private:
+    std::atomic<task_base*> head_{nullptr};
+};
+
+
+// invocable_task adapts an invocable to task_base for contexts' execute functions
+// it is the only allocation on those paths and is drawn from pool_allocator
+template<class F>
+struct invocable_task : task_base
+{
+  using allocator_type = execution::pool_allocator<invocable_task>;
+  using allocator_traits = std::allocator_traits<allocator_type>;
+
+  F f_;
+
+  template<class OtherF>
+  explicit invocable_task(OtherF&& f)
+    : task_base(&invocable_task::execute),
+      f_(std::forward<OtherF>(f))
+  {}
+
+  template<class OtherF>
+  static invocable_task* make(OtherF&& f)
+  {
+    allocator_type alloc;
+    invocable_task* result = allocator_traits::allocate(alloc, 1);
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+    allocator_traits::construct(alloc, result, std::forward<OtherF>(f));
+#else
+    try
+    {
+      allocator_traits::construct(alloc, result, std::forward<OtherF>(f));
+    }
+    catch(...)
+    {
+      allocator_traits::deallocate(alloc, result, 1);
+      throw;
+    }
+#endif
+
+    return result;
+  }
+
+  static void destroy(invocable_task* self) noexcept
+  {
+    allocator_type alloc;
+    allocator_traits::destroy(alloc, self);
+    allocator_traits::deallocate(alloc, self, 1);
+  }
+
+  static void execute(task_base* task) noexcept
+  {
+    invocable_task* self = static_cast<invocable_task*>(task);
+
+    std::invoke(self->f_);
+
+    destroy(self);
+  }
+};
+
+
+// links make_task(std::move(element)) for each element of range into a single batch and passes it
+// to context.enqueue(intrusive_queue&&, std::size_t)
+// if make_task throws, the tasks made so far are still enqueued before the exception propagates
+template<class Context, class Range, class MakeTask>
+void enqueue_batch(const Context& context, Range&& range, MakeTask make_task)
+{
+  intrusive_queue batch;
+  std::size_t num_tasks = 0;
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+  for(auto& element : range)
+  {
+    batch.push_back(make_task(std::move(element)));
+    ++num_tasks;
+  }
+#else
+  try
+  {
+    for(auto& element : range)
+    {
+      batch.push_back(make_task(std::move(element)));
+      ++num_tasks;
+    }
+  }
+  catch(...)
+  {
+    context.enqueue(std::move(batch), num_tasks);
+    throw;
+  }
+#endif
+
+  context.enqueue(std::move(batch), num_tasks);
+}
+
+
+// Context is enqueued upon via context.enqueue(task_base*), and a task_operation
+// completes its receiver on whichever thread the context executes it
+template<class Context, class R>
+struct task_operation : task_base
+{
+  const Context& context_;
+  remove_cvref_t<R> receiver_;
+
+  template<class OtherR>
+  task_operation(const Context& context, OtherR&& r)
+    : task_base(&task_operation::execute),
+      context_(context),
+      receiver_(std::forward<OtherR>(r))
+  {}
+
+  // the context links this object into its queues, so it must not move
+  task_operation(task_operation&&) = delete;
+
+  void start() noexcept
+  {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+    context_.enqueue(this);
+#else
+    try
+    {
+      context_.enqueue(this);
+    }
+    catch(...)
+    {
+      execution::set_error(std::move(receiver_), std::current_exception());
+    }
+#endif
+  }
+
+  static void execute(task_base* task) noexcept
+  {
+    task_operation& self = *static_cast<task_operation*>(task);
+
+    // work nobody wants any longer is not run
+    if(execution::get_stop_token(self.receiver_).stop_requested())
+    {
+      execution::set_done(std::move(self.receiver_));
+      return;
+    }
+
+    execution::detail::set_value_or_error(std::move(self.receiver_));
+  }
+};
+
+
+} // end detail
+
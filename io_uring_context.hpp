@@ -0,0 +1,910 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include "execution.hpp"
+#include "intrusive_queue.hpp"
+#include <linux/io_uring.h>
+#include <optional>
+#include <span>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+
+namespace detail
+{
+
+
+// a minimal io_uring, driven through the raw system calls
+// only a single thread may call get_sqe, submit and for_each_completion
+class io_uring
+{
+  public:
+    // a failure to set up the ring is reported through ec, after which the ring may only be destroyed
+    io_uring(unsigned entries, std::error_code& ec) noexcept
+    {
+      io_uring_params params;
+      std::memset(&params, 0, sizeof(params));
+
+      fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+
+      if(fd_ < 0)
+      {
+        ec.assign(errno, std::system_category());
+        return;
+      }
+
+      sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+      sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+      // since Linux 5.4, both rings share one mapping
+      bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+
+      if(single_mmap)
+      {
+        sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+      }
+
+      sq_ring_ = map(sq_size_, IORING_OFF_SQ_RING);
+      cq_ring_ = single_mmap ? sq_ring_ : map(cq_size_, IORING_OFF_CQ_RING);
+      sqes_ = static_cast<io_uring_sqe*>(map(sqes_size_, IORING_OFF_SQES));
+
+      if(sq_ring_ == MAP_FAILED or cq_ring_ == MAP_FAILED or sqes_ == MAP_FAILED)
+      {
+        ec.assign(errno, std::system_category());
+        unmap();
+        fd_ = -1;
+        return;
+      }
+
+      char* sq = static_cast<char*>(sq_ring_);
+      sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+      sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+      sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+      sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+      sq_entries_ = params.sq_entries;
+      sq_local_tail_ = *sq_tail_;
+
+      char* cq = static_cast<char*>(cq_ring_);
+      cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+      cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+      cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+      cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    io_uring(const io_uring&) = delete;
+
+    ~io_uring()
+    {
+      unmap();
+    }
+
+    // returns a zeroed entry to fill in, or nullptr when the submission queue is full
+    io_uring_sqe* get_sqe() noexcept
+    {
+      unsigned head = std::atomic_ref(*sq_head_).load(std::memory_order_acquire);
+
+      if(sq_local_tail_ - head == sq_entries_)
+      {
+        return nullptr;
+      }
+
+      unsigned index = sq_local_tail_ & sq_mask_;
+      io_uring_sqe* result = &sqes_[index];
+      std::memset(result, 0, sizeof(*result));
+
+      sq_array_[index] = index;
+      ++sq_local_tail_;
+      ++num_unsubmitted_;
+
+      return result;
+    }
+
+    // submits every entry returned by get_sqe so far with a single system call,
+    // blocking until at least min_complete completions are available
+    void submit(unsigned min_complete) noexcept
+    {
+      std::atomic_ref(*sq_tail_).store(sq_local_tail_, std::memory_order_release);
+
+      unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+
+      if(num_unsubmitted_ == 0 and min_complete == 0)
+      {
+        return;
+      }
+
+      int result = static_cast<int>(::syscall(__NR_io_uring_enter, fd_, num_unsubmitted_, min_complete, flags, nullptr, 0));
+
+      if(result >= 0)
+      {
+        num_unsubmitted_ -= static_cast<unsigned>(result);
+      }
+      else if(errno != EINTR and errno != EAGAIN and errno != EBUSY)
+      {
+        // the remaining errors indicate a malformed ring
+        std::terminate();
+      }
+    }
+
+    // calls f(user_data, res) for each available completion
+    // each completion is consumed before f is called, so f may submit more work
+    template<class F>
+    void for_each_completion(F f)
+    {
+      unsigned head = *cq_head_;
+      unsigned tail = std::atomic_ref(*cq_tail_).load(std::memory_order_acquire);
+
+      for(; head != tail; tail = std::atomic_ref(*cq_tail_).load(std::memory_order_acquire))
+      {
+        while(head != tail)
+        {
+          io_uring_cqe cqe = cqes_[head & cq_mask_];
+          ++head;
+          std::atomic_ref(*cq_head_).store(head, std::memory_order_release);
+
+          f(cqe.user_data, cqe.res);
+        }
+      }
+    }
+
+  private:
+    void* map(std::size_t size, off_t offset) noexcept
+    {
+      return ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+    }
+
+    void unmap() noexcept
+    {
+      if(sqes_ and sqes_ != MAP_FAILED)
+      {
+        ::munmap(sqes_, sqes_size_);
+      }
+
+      if(cq_ring_ and cq_ring_ != MAP_FAILED and cq_ring_ != sq_ring_)
+      {
+        ::munmap(cq_ring_, cq_size_);
+      }
+
+      if(sq_ring_ and sq_ring_ != MAP_FAILED)
+      {
+        ::munmap(sq_ring_, sq_size_);
+      }
+
+      sqes_ = nullptr;
+      cq_ring_ = sq_ring_ = nullptr;
+
+      if(fd_ >= 0)
+      {
+        ::close(fd_);
+      }
+    }
+
+    int fd_;
+
+    std::size_t sq_size_;
+    std::size_t cq_size_;
+    std::size_t sqes_size_;
+
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned sq_mask_;
+    unsigned* sq_array_;
+    unsigned sq_entries_;
+    unsigned sq_local_tail_;
+    unsigned num_unsubmitted_ = 0;
+
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+    io_uring_cqe* cqes_;
+};
+
+
+// returns -1, having reported the failure through ec, if no eventfd could be created
+inline int make_eventfd(std::error_code& ec) noexcept
+{
+  int result = ::eventfd(0, EFD_CLOEXEC);
+
+  if(result < 0)
+  {
+    ec.assign(errno, std::system_category());
+  }
+
+  return result;
+}
+
+
+} // end detail
+
+
+// io_uring_context runs an io_uring on a single dedicated thread
+//
+// its executor is a scheduler whose senders complete on that thread, and a source of
+// async_read, async_write and async_accept senders. an I/O operation state is the SQE's user_data,
+// so starting one allocates nothing. operations started on the ring's thread, typically from
+// the completion of an earlier one, fill in an SQE directly; operations started elsewhere are handed
+// to the thread through a lock-free queue. either way, the thread submits every SQE prepared during
+// one turn of its loop with a single io_uring_enter, which also waits for completions when idle
+//
+// I/O errors are delivered through set_error as std::system_error, or without exceptions, as the
+// std::error_code of the failed operation's errno. a stop request on an I/O operation's receiver
+// cancels it with IORING_OP_ASYNC_CANCEL, so that a read or accept which may never complete does not
+// hang. operations cancelled by a stop request or by the context's destruction complete with set_done
+class io_uring_context
+{
+  public:
+    // the offset which reads or writes at, and advances, the file's current position
+    static constexpr std::uint64_t current_position = static_cast<std::uint64_t>(-1);
+
+    // throws std::system_error if the ring cannot be set up. without exceptions, the failure is
+    // reported by setup_error instead, and the context may then only be destroyed
+    explicit io_uring_context(unsigned entries = 256)
+      : ring_(entries, setup_error_),
+        wakeup_fd_(setup_error_ ? -1 : detail::make_eventfd(setup_error_)),
+        stop_task_(&io_uring_context::stop)
+    {
+      if(setup_error_)
+      {
+#if !defined(EXECUTION_NO_EXCEPTIONS)
+        throw std::system_error(setup_error_, "io_uring_context");
+#endif
+        return;
+      }
+
+      thread_ = std::thread([this]{ run(); });
+    }
+
+    io_uring_context(const io_uring_context&) = delete;
+
+    // outstanding work is completed, and outstanding I/O cancelled, before the destructor returns
+    ~io_uring_context()
+    {
+      if(thread_.joinable())
+      {
+        enqueue(&stop_task_);
+        thread_.join();
+      }
+
+      if(wakeup_fd_ >= 0)
+      {
+        ::close(wakeup_fd_);
+      }
+    }
+
+    std::error_code setup_error() const noexcept
+    {
+      return setup_error_;
+    }
+
+    void enqueue(detail::task_base* task) const noexcept
+    {
+      if(on_ring_thread())
+      {
+        local_queue_.push_back(task);
+      }
+      else if(remote_queue_.push(task))
+      {
+        wake();
+      }
+    }
+
+    // enqueues num_tasks tasks with a single CAS and at most one wakeup
+    void enqueue(detail::intrusive_queue&& tasks, std::size_t) const noexcept
+    {
+      if(on_ring_thread())
+      {
+        local_queue_.append(std::move(tasks));
+      }
+      else if(remote_queue_.push_all(std::move(tasks)))
+      {
+        wake();
+      }
+    }
+
+    std::thread::id get_id() const noexcept
+    {
+      return thread_.get_id();
+    }
+
+
+    template<execution::receiver_of R>
+    using operation = detail::task_operation<io_uring_context, R>;
+
+
+    struct sender_type
+    {
+      template<template<class...> class Tuple, template<class...> class Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template<template<class...> class Variant>
+      using error_types = Variant<execution::error_type>;
+
+      static constexpr bool sends_done = true;
+
+      const io_uring_context& context_;
+
+      template<execution::receiver_of R>
+      operation<R> connect(R&& r) const
+      {
+        return {context_, std::forward<R>(r)};
+      }
+
+      template<class Rs>
+        requires execution::receiver_of<execution::detail::range_value_t<Rs>>
+      void submit_batch(Rs&& receivers) const
+      {
+        using submit_receiver = execution::detail::submit_receiver<const sender_type&, execution::detail::range_value_t<Rs>>;
+
+        detail::enqueue_batch(context_, receivers, [this](auto&& r)
+        {
+          return &submit_receiver::make(*this, std::move(r))->state_;
+        });
+      }
+    };
+
+
+  private:
+    // the part of an I/O operation state the ring refers to through an SQE's user_data
+    // it is a task_base so that an operation started off the ring's thread can be handed to it
+    struct io_operation_base : detail::task_base
+    {
+      // hands a stop request to the ring's thread, which alone may cancel the operation
+      struct cancel_task : detail::task_base
+      {
+        io_operation_base* op_;
+
+        explicit cancel_task(io_operation_base* op) noexcept
+          : detail::task_base(&cancel_task::execute),
+            op_(op)
+        {}
+
+        // runs on the ring's thread
+        static void execute(detail::task_base* task) noexcept
+        {
+          io_operation_base* op = static_cast<cancel_task*>(task)->op_;
+          const_cast<io_uring_context&>(op->context_).cancel(op);
+        }
+      };
+
+      enum class stage_type : unsigned char { unprepared, in_flight, completed };
+
+      const io_uring_context& context_;
+      void (*prepare_)(io_operation_base*, io_uring_sqe*) noexcept;
+      void (*complete_)(io_operation_base*, int) noexcept;
+      cancel_task cancel_task_;
+
+      // set by a stop request, before it enqueues cancel_task_
+      std::atomic<bool> cancel_requested_;
+
+      // only touched on the ring's thread
+      stage_type stage_;
+      bool cancelled_;
+      int result_;
+
+      io_operation_base(const io_uring_context& context,
+                        void (*prepare)(io_operation_base*, io_uring_sqe*) noexcept,
+                        void (*complete)(io_operation_base*, int) noexcept) noexcept
+        : detail::task_base(&io_operation_base::execute),
+          context_(context),
+          prepare_(prepare),
+          complete_(complete),
+          cancel_task_(this),
+          cancel_requested_(false),
+          stage_(stage_type::unprepared),
+          cancelled_(false),
+          result_(0)
+      {}
+
+      // runs on the ring's thread
+      static void execute(detail::task_base* task) noexcept
+      {
+        io_operation_base* self = static_cast<io_operation_base*>(task);
+        const_cast<io_uring_context&>(self->context_).prepare(self);
+      }
+
+      // may run on any thread
+      void request_cancel() noexcept
+      {
+        cancel_requested_.store(true, std::memory_order_release);
+        context_.enqueue(&cancel_task_);
+      }
+
+      // returns false if a cancellation was enqueued but has yet to run, having stored result for it to
+      // deliver instead: the queued cancellation refers to this object, which the receiver may destroy once
+      // it completes. the caller must first destroy the stop callback, so that no more can be enqueued
+      bool ready_to_complete(int result) noexcept
+      {
+        if(cancel_requested_.load(std::memory_order_acquire) and !cancelled_)
+        {
+          stage_ = stage_type::completed;
+          result_ = result;
+          return false;
+        }
+
+        return true;
+      }
+    };
+
+
+    // Op describes the SQE to prepare and the value a successful result sends
+    template<class Op, class R>
+    struct io_operation : io_operation_base
+    {
+      struct cancel_callback
+      {
+        io_operation* self_;
+
+        void operator()() const noexcept
+        {
+          self_->request_cancel();
+        }
+      };
+
+      using stop_callback_type = typename execution::stop_token_of_t<R>::template callback_type<cancel_callback>;
+
+      Op op_;
+      R receiver_;
+      std::optional<stop_callback_type> stop_callback_;
+
+      template<class OtherR>
+      io_operation(const io_uring_context& context, const Op& op, OtherR&& r)
+        : io_operation_base(context, &io_operation::prepare, &io_operation::complete),
+          op_(op),
+          receiver_(std::forward<OtherR>(r))
+      {}
+
+      // the ring refers to this object, so it must not move
+      io_operation(io_operation&&) = delete;
+
+      // a stop request on the receiver's token cancels the operation as soon as it is made
+      void start() noexcept
+      {
+        // work nobody wants any longer is not submitted
+        if(execution::get_stop_token(receiver_).stop_requested())
+        {
+          execution::set_done(std::move(receiver_));
+          return;
+        }
+
+        stop_callback_.emplace(execution::get_stop_token(receiver_), cancel_callback{this});
+        context_.submit(this);
+      }
+
+      static void prepare(io_operation_base* base, io_uring_sqe* sqe) noexcept
+      {
+        static_cast<io_operation*>(base)->op_.prepare(sqe);
+      }
+
+      static void complete(io_operation_base* base, int result) noexcept
+      {
+        io_operation& self = *static_cast<io_operation*>(base);
+
+        self.stop_callback_.reset();
+
+        if(!self.ready_to_complete(result))
+        {
+          return;
+        }
+
+        if(result == -ECANCELED)
+        {
+          execution::set_done(std::move(self.receiver_));
+        }
+        else if(result < 0)
+        {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+          execution::set_error(std::move(self.receiver_), std::error_code(-result, std::system_category()));
+#else
+          execution::set_error(std::move(self.receiver_), std::make_exception_ptr(std::system_error(-result, std::system_category(), Op::name)));
+#endif
+        }
+        else
+        {
+          execution::detail::set_value_or_error(std::move(self.receiver_), static_cast<typename Op::value_type>(result));
+        }
+      }
+    };
+
+
+    template<class Op>
+    struct io_sender
+    {
+      template<template<class...> class Tuple, template<class...> class Variant>
+      using value_types = Variant<Tuple<typename Op::value_type>>;
+
+      template<template<class...> class Variant>
+      using error_types = Variant<execution::error_type>;
+
+      static constexpr bool sends_done = true;
+
+      const io_uring_context& context_;
+      Op op_;
+
+      template<execution::receiver_of<typename Op::value_type> R>
+      io_operation<Op, remove_cvref_t<R>> connect(R&& r) const
+      {
+        return {context_, op_, std::forward<R>(r)};
+      }
+    };
+
+
+    struct read_op
+    {
+      using value_type = std::size_t;
+      static constexpr const char* name = "async_read";
+
+      int fd_;
+      std::span<std::byte> buffer_;
+      std::uint64_t offset_;
+
+      void prepare(io_uring_sqe* sqe) const noexcept
+      {
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fd_;
+        sqe->addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
+        sqe->len = static_cast<unsigned>(buffer_.size());
+        sqe->off = offset_;
+      }
+    };
+
+
+    struct write_op
+    {
+      using value_type = std::size_t;
+      static constexpr const char* name = "async_write";
+
+      int fd_;
+      std::span<const std::byte> buffer_;
+      std::uint64_t offset_;
+
+      void prepare(io_uring_sqe* sqe) const noexcept
+      {
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = fd_;
+        sqe->addr = reinterpret_cast<std::uintptr_t>(buffer_.data());
+        sqe->len = static_cast<unsigned>(buffer_.size());
+        sqe->off = offset_;
+      }
+    };
+
+
+    struct accept_op
+    {
+      using value_type = int;
+      static constexpr const char* name = "async_accept";
+
+      int fd_;
+
+      void prepare(io_uring_sqe* sqe) const noexcept
+      {
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = fd_;
+        sqe->accept_flags = SOCK_CLOEXEC;
+      }
+    };
+
+  public:
+    using read_sender = io_sender<read_op>;
+    using write_sender = io_sender<write_op>;
+    using accept_sender = io_sender<accept_op>;
+
+
+    struct executor_type
+    {
+      const io_uring_context* context_;
+
+      template<class F>
+        requires invocable<remove_cvref_t<F>&>
+      void execute(F&& f) const
+      {
+        context_->enqueue(detail::invocable_task<remove_cvref_t<F>>::make(std::forward<F>(f)));
+      }
+
+      template<class Fs>
+        requires invocable<execution::detail::range_value_t<Fs>&>
+      void execute_batch(Fs&& fs) const
+      {
+        detail::enqueue_batch(*context_, fs, [](auto&& f)
+        {
+          return detail::invocable_task<remove_cvref_t<decltype(f)>>::make(std::move(f));
+        });
+      }
+
+      sender_type schedule() const noexcept
+      {
+        return {*context_};
+      }
+
+      read_sender async_read(int fd, std::span<std::byte> buffer, std::uint64_t offset = current_position) const noexcept
+      {
+        return {*context_, {fd, buffer, offset}};
+      }
+
+      write_sender async_write(int fd, std::span<const std::byte> buffer, std::uint64_t offset = current_position) const noexcept
+      {
+        return {*context_, {fd, buffer, offset}};
+      }
+
+      accept_sender async_accept(int fd) const noexcept
+      {
+        return {*context_, {fd}};
+      }
+
+      friend bool operator==(const executor_type& a, const executor_type& b)
+      {
+        return a.context_ == b.context_;
+      }
+
+      friend bool operator!=(const executor_type& a, const executor_type& b)
+      {
+        return !(a == b);
+      }
+    };
+
+    executor_type executor() const
+    {
+      return {this};
+    }
+
+  private:
+    // user_data of entries which do not belong to an io_operation_base
+    static constexpr std::uint64_t cancel_user_data = 0;
+    static constexpr std::uint64_t wakeup_user_data = 1;
+    static constexpr std::uint64_t cancel_operation_user_data = 2;
+
+    struct stop_task : detail::task_base
+    {
+      using detail::task_base::task_base;
+      bool stopped_ = false;
+    };
+
+    static void stop(detail::task_base* task) noexcept
+    {
+      static_cast<stop_task*>(task)->stopped_ = true;
+    }
+
+    static const io_uring_context*& this_thread() noexcept
+    {
+      thread_local const io_uring_context* result = nullptr;
+      return result;
+    }
+
+    bool on_ring_thread() const noexcept
+    {
+      return this_thread() == this;
+    }
+
+    // completes the read the ring's thread keeps pending on wakeup_fd_
+    void wake() const noexcept
+    {
+      std::uint64_t one = 1;
+      [[maybe_unused]] auto result = ::write(wakeup_fd_, &one, sizeof(one));
+    }
+
+    void submit(io_operation_base* op) const noexcept
+    {
+      if(on_ring_thread())
+      {
+        const_cast<io_uring_context*>(this)->prepare(op);
+      }
+      else
+      {
+        enqueue(op);
+      }
+    }
+
+    io_uring_sqe* get_sqe() noexcept
+    {
+      io_uring_sqe* result = ring_.get_sqe();
+
+      if(!result)
+      {
+        // make room by submitting what has been prepared so far
+        ring_.submit(0);
+        result = ring_.get_sqe();
+      }
+
+      return result;
+    }
+
+    // runs on the ring's thread
+    void prepare(io_operation_base* op) noexcept
+    {
+      if(op->cancelled_)
+      {
+        // the operation's cancellation ran before it could be prepared
+        op->complete_(op, -ECANCELED);
+        return;
+      }
+
+      io_uring_sqe* sqe = get_sqe();
+
+      if(!sqe)
+      {
+        // the kernel is backed up; retry once completions have been reaped
+        blocked_operations_.push_back(op);
+        return;
+      }
+
+      op->prepare_(op, sqe);
+      sqe->user_data = reinterpret_cast<std::uintptr_t>(op);
+      op->stage_ = io_operation_base::stage_type::in_flight;
+      ++num_operations_in_flight_;
+    }
+
+    // runs on the ring's thread, once for each operation whose stop was requested
+    // an operation not yet prepared is completed when it would have been; one in flight is cancelled by
+    // the kernel; one which completed while this cancellation was queued is completed now
+    void cancel(io_operation_base* op) noexcept
+    {
+      if(op->stage_ == io_operation_base::stage_type::in_flight)
+      {
+        io_uring_sqe* sqe = get_sqe();
+
+        if(!sqe)
+        {
+          // retry once the kernel has made room
+          local_queue_.push_back(&op->cancel_task_);
+          return;
+        }
+
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = reinterpret_cast<std::uintptr_t>(op);
+        sqe->user_data = cancel_operation_user_data;
+      }
+
+      op->cancelled_ = true;
+
+      if(op->stage_ == io_operation_base::stage_type::completed)
+      {
+        op->complete_(op, op->result_);
+      }
+    }
+
+    bool arm_wakeup() noexcept
+    {
+      if(io_uring_sqe* sqe = get_sqe())
+      {
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = wakeup_fd_;
+        sqe->addr = reinterpret_cast<std::uintptr_t>(&wakeup_buffer_);
+        sqe->len = sizeof(wakeup_buffer_);
+        sqe->user_data = wakeup_user_data;
+        return true;
+      }
+
+      return false;
+    }
+
+    void cancel_all_operations() noexcept
+    {
+      if(io_uring_sqe* sqe = get_sqe())
+      {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+        sqe->user_data = cancel_user_data;
+        cancel_in_flight_ = true;
+      }
+    }
+
+    void complete(std::uint64_t user_data, int result) noexcept
+    {
+      if(user_data == cancel_user_data)
+      {
+        cancel_in_flight_ = false;
+      }
+      else if(user_data == cancel_operation_user_data)
+      {
+        // the operation it targeted reports the outcome
+      }
+      else if(user_data == wakeup_user_data)
+      {
+        // once stopping, the wakeup is no longer rearmed, so that the loop can exit
+        wakeup_armed_ = !stop_task_.stopped_ and arm_wakeup();
+      }
+      else
+      {
+        --num_operations_in_flight_;
+
+        io_operation_base* op = reinterpret_cast<io_operation_base*>(user_data);
+        op->complete_(op, result);
+      }
+    }
+
+    void run() noexcept
+    {
+      this_thread() = this;
+      wakeup_armed_ = arm_wakeup();
+
+      while(true)
+      {
+        if(!wakeup_armed_ and !stop_task_.stopped_)
+        {
+          wakeup_armed_ = arm_wakeup();
+        }
+
+        // run the tasks enqueued so far; those they enqueue wait for the next turn so that I/O is not starved
+        local_queue_.append(remote_queue_.pop_all());
+        detail::intrusive_queue tasks = std::move(local_queue_);
+
+        while(detail::task_base* task = tasks.pop_front())
+        {
+          task->execute();
+        }
+
+        if(stop_task_.stopped_)
+        {
+          bool has_work = !local_queue_.empty() or !remote_queue_.empty() or !blocked_operations_.empty();
+
+          if(num_operations_in_flight_ > 0)
+          {
+            if(!cancel_in_flight_)
+            {
+              cancel_all_operations();
+            }
+          }
+          else if(!has_work)
+          {
+            if(!wakeup_armed_)
+            {
+              break;
+            }
+
+            wake();
+          }
+        }
+
+        bool idle = local_queue_.empty() and remote_queue_.empty();
+        ring_.submit(idle ? 1 : 0);
+
+        ring_.for_each_completion([this](std::uint64_t user_data, int result)
+        {
+          complete(user_data, result);
+        });
+
+        for(detail::intrusive_queue blocked = std::move(blocked_operations_); !blocked.empty();)
+        {
+          prepare(static_cast<io_operation_base*>(blocked.pop_front()));
+        }
+      }
+
+      this_thread() = nullptr;
+    }
+
+    std::error_code setup_error_;
+    detail::io_uring ring_;
+    int wakeup_fd_;
+    std::uint64_t wakeup_buffer_ = 0;
+    bool wakeup_armed_ = false;
+    bool cancel_in_flight_ = false;
+    std::size_t num_operations_in_flight_ = 0;
+
+    mutable detail::atomic_intrusive_queue remote_queue_;
+
+    // only touched on the ring's thread
+    mutable detail::intrusive_queue local_queue_;
+    detail::intrusive_queue blocked_operations_;
+
+    stop_task stop_task_;
+    std::thread thread_;
+};
+
+
+static_assert(execution::executor<io_uring_context::executor_type>);
+static_assert(execution::scheduler<io_uring_context::executor_type>);
@@ -0,0 +1,614 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include "execution.hpp"
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// the parallel algorithms run the std parallel algorithms upon an executor rather than an execution policy
+//
+// each partitions its range into chunks of whole cache lines, large enough that dispatching a chunk costs
+// little next to processing it, and numerous enough that threads finishing early take over the chunks of
+// slower ones. chunks are claimed from a shared counter by helpers dispatched through execution::bulk_execute,
+// and by the calling thread itself, which returns once every chunk has run. because the caller takes part,
+// an algorithm may be called from one of its executor's own threads
+//
+// as with std::execution::par_unseq, the invocations within a chunk are unsequenced so that its loop may be
+// vectorized, and element access functions must not synchronize with one another. an exception escaping
+// one calls std::terminate
+//
+// ranges must be random access. like every other customization point, each algorithm may be customized by
+// the executor it is given
+
+
+// asserts that the iterations of the loop which follows are independent, so that it may be vectorized
+#if defined(__clang__)
+#define EXECUTION_VECTORIZE_LOOP _Pragma("clang loop vectorize(enable) interleave(enable)")
+#elif defined(__GNUC__)
+#define EXECUTION_VECTORIZE_LOOP _Pragma("GCC ivdep")
+#else
+#define EXECUTION_VECTORIZE_LOOP
+#endif
+
+
+namespace execution
+{
+namespace detail
+{
+
+
+inline constexpr std::size_t cache_line_size = 64;
+
+// the fewest bytes of elements a chunk holds
+inline constexpr std::size_t parallel_min_chunk_bytes = 16 * 1024;
+
+// the number of chunks per thread a range is partitioned into, once it is large enough
+inline constexpr std::size_t parallel_chunks_per_thread = 8;
+
+
+inline std::size_t parallel_num_threads() noexcept
+{
+  static const std::size_t result = std::max(1u, std::thread::hardware_concurrency());
+  return result;
+}
+
+
+// the partition of n elements into chunks of chunk_size_, the last of which may be shorter
+struct parallel_partition
+{
+  std::size_t n_;
+  std::size_t chunk_size_;
+
+  parallel_partition(std::size_t n, std::size_t element_size) noexcept
+    : n_(n)
+  {
+    std::size_t per_line = std::max<std::size_t>(1, cache_line_size / element_size);
+    std::size_t size = std::max({per_line, parallel_min_chunk_bytes / element_size, n / (parallel_chunks_per_thread * parallel_num_threads())});
+
+    // rounded up to whole cache lines
+    chunk_size_ = (size + per_line - 1) / per_line * per_line;
+  }
+
+  std::size_t num_chunks() const noexcept
+  {
+    return (n_ + chunk_size_ - 1) / chunk_size_;
+  }
+
+  template<std::random_access_iterator I>
+  I begin(I first, std::size_t chunk) const noexcept
+  {
+    return first + static_cast<std::iter_difference_t<I>>(chunk * chunk_size_);
+  }
+
+  template<std::random_access_iterator I>
+  I end(I first, std::size_t chunk) const noexcept
+  {
+    return first + static_cast<std::iter_difference_t<I>>(std::min(n_, (chunk + 1) * chunk_size_));
+  }
+};
+
+
+// the chunks of a single call to for_each_chunk
+//
+// helpers may start only after the call has returned, so they share ownership of this state. by then
+// no chunks remain for them to claim, so they never touch the chunk function, which the caller owns
+template<class F>
+struct chunk_state
+{
+  F* f_;
+  std::size_t num_chunks_;
+  std::atomic<std::size_t> next_chunk_;
+  std::atomic<std::size_t> num_finished_;
+
+  chunk_state(F* f, std::size_t num_chunks) noexcept
+    : f_(f),
+      num_chunks_(num_chunks),
+      next_chunk_(0),
+      num_finished_(0)
+  {}
+
+  void run() noexcept
+  {
+    for(std::size_t chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed);
+        chunk < num_chunks_;
+        chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed))
+    {
+      (*f_)(chunk);
+
+      if(num_finished_.fetch_add(1, std::memory_order_acq_rel) + 1 == num_chunks_)
+      {
+        num_finished_.notify_all();
+      }
+    }
+  }
+};
+
+
+// invokes f(chunk) for each chunk in [0, num_chunks) upon ex and the calling thread
+// returns once every invocation has returned
+template<class E, class F>
+void for_each_chunk(E&& ex, std::size_t num_chunks, F f)
+{
+  if(num_chunks <= 1)
+  {
+    if(num_chunks == 1)
+    {
+      f(0);
+    }
+
+    return;
+  }
+
+  auto state = std::make_shared<chunk_state<F>>(&f, num_chunks);
+
+  auto helper = [state](std::size_t)
+  {
+    state->run();
+  };
+
+  std::size_t num_helpers = std::min(num_chunks, parallel_num_threads()) - 1;
+
+  if(num_helpers > 0)
+  {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+    execution::bulk_execute(ex, helper, num_helpers);
+#else
+    // helpers are only an optimization: if they cannot be dispatched, the caller runs every chunk itself
+    try
+    {
+      execution::bulk_execute(ex, helper, num_helpers);
+    }
+    catch(...)
+    {
+    }
+#endif
+  }
+
+  state->run();
+
+  for(std::size_t num_finished = state->num_finished_.load(std::memory_order_acquire);
+      num_finished != num_chunks;
+      num_finished = state->num_finished_.load(std::memory_order_acquire))
+  {
+    state->num_finished_.wait(num_finished, std::memory_order_acquire);
+  }
+}
+
+
+template<class E, std::random_access_iterator I, class F>
+void parallel_for_each(E&& ex, I first, I last, F& f)
+{
+  parallel_partition p(static_cast<std::size_t>(last - first), sizeof(std::iter_value_t<I>));
+
+  detail::for_each_chunk(ex, p.num_chunks(), [&](std::size_t chunk)
+  {
+    I i = p.begin(first, chunk);
+    std::iter_difference_t<I> n = p.end(first, chunk) - i;
+
+    EXECUTION_VECTORIZE_LOOP
+    for(std::iter_difference_t<I> k = 0; k < n; ++k)
+    {
+      std::invoke(f, i[k]);
+    }
+  });
+}
+
+
+template<class E, std::random_access_iterator I, std::random_access_iterator O, class F>
+O parallel_transform(E&& ex, I first, I last, O d_first, F& f)
+{
+  parallel_partition p(static_cast<std::size_t>(last - first), sizeof(std::iter_value_t<O>));
+
+  detail::for_each_chunk(ex, p.num_chunks(), [&](std::size_t chunk)
+  {
+    I i = p.begin(first, chunk);
+    std::iter_difference_t<I> n = p.end(first, chunk) - i;
+    O o = p.begin(d_first, chunk);
+
+    EXECUTION_VECTORIZE_LOOP
+    for(std::iter_difference_t<I> k = 0; k < n; ++k)
+    {
+      o[k] = std::invoke(f, i[k]);
+    }
+  });
+
+  return p.end(d_first, p.num_chunks());
+}
+
+
+template<class E, std::random_access_iterator I1, std::random_access_iterator I2, std::random_access_iterator O, class F>
+O parallel_transform(E&& ex, I1 first1, I1 last1, I2 first2, O d_first, F& f)
+{
+  parallel_partition p(static_cast<std::size_t>(last1 - first1), sizeof(std::iter_value_t<O>));
+
+  detail::for_each_chunk(ex, p.num_chunks(), [&](std::size_t chunk)
+  {
+    I1 i1 = p.begin(first1, chunk);
+    std::iter_difference_t<I1> n = p.end(first1, chunk) - i1;
+    I2 i2 = p.begin(first2, chunk);
+    O o = p.begin(d_first, chunk);
+
+    EXECUTION_VECTORIZE_LOOP
+    for(std::iter_difference_t<I1> k = 0; k < n; ++k)
+    {
+      o[k] = std::invoke(f, i1[k], i2[k]);
+    }
+  });
+
+  return p.end(d_first, p.num_chunks());
+}
+
+
+// each chunk is reduced in order, and the chunks' results are then combined in order with init
+template<class E, std::random_access_iterator I, class T, class R, class U>
+T parallel_transform_reduce(E&& ex, I first, I last, T init, R& reduce, U& transform)
+{
+  parallel_partition p(static_cast<std::size_t>(last - first), sizeof(std::iter_value_t<I>));
+
+  std::vector<std::optional<T>> partials(p.num_chunks());
+
+  detail::for_each_chunk(ex, p.num_chunks(), [&](std::size_t chunk)
+  {
+    I i = p.begin(first, chunk);
+    std::iter_difference_t<I> n = p.end(first, chunk) - i;
+
+    T sum = std::invoke(transform, i[0]);
+
+    EXECUTION_VECTORIZE_LOOP
+    for(std::iter_difference_t<I> k = 1; k < n; ++k)
+    {
+      sum = std::invoke(reduce, std::move(sum), std::invoke(transform, i[k]));
+    }
+
+    partials[chunk].emplace(std::move(sum));
+  });
+
+  for(std::optional<T>& partial : partials)
+  {
+    init = std::invoke(reduce, std::move(init), std::move(*partial));
+  }
+
+  return init;
+}
+
+
+template<class E, std::random_access_iterator I1, std::random_access_iterator I2, class T, class R, class U>
+T parallel_transform_reduce(E&& ex, I1 first1, I1 last1, I2 first2, T init, R& reduce, U& transform)
+{
+  parallel_partition p(static_cast<std::size_t>(last1 - first1), sizeof(std::iter_value_t<I1>));
+
+  std::vector<std::optional<T>> partials(p.num_chunks());
+
+  detail::for_each_chunk(ex, p.num_chunks(), [&](std::size_t chunk)
+  {
+    I1 i1 = p.begin(first1, chunk);
+    std::iter_difference_t<I1> n = p.end(first1, chunk) - i1;
+    I2 i2 = p.begin(first2, chunk);
+
+    T sum = std::invoke(transform, i1[0], i2[0]);
+
+    EXECUTION_VECTORIZE_LOOP
+    for(std::iter_difference_t<I1> k = 1; k < n; ++k)
+    {
+      sum = std::invoke(reduce, std::move(sum), std::invoke(transform, i1[k], i2[k]));
+    }
+
+    partials[chunk].emplace(std::move(sum));
+  });
+
+  for(std::optional<T>& partial : partials)
+  {
+    init = std::invoke(reduce, std::move(init), std::move(*partial));
+  }
+
+  return init;
+}
+
+
+// scans in two passes over the chunks: the first reduces each chunk, and the second scans each chunk
+// starting from the reduction of init, if any, and of every chunk before it
+template<class T, class E, std::random_access_iterator I, std::random_access_iterator O, class R>
+O parallel_inclusive_scan(E&& ex, I first, I last, O d_first, R& reduce, std::optional<T> init)
+{
+  parallel_partition p(static_cast<std::size_t>(last - first), sizeof(std::iter_value_t<O>));
+
+  std::size_t num_chunks = p.num_chunks();
+
+  // carries[chunk] is the value scanning chunk begins from
+  std::vector<std::optional<T>> carries(num_chunks);
+
+  if(num_chunks > 0)
+  {
+    carries[0] = std::move(init);
+  }
+
+  if(num_chunks > 1)
+  {
+    // the last chunk's reduction is never carried
+    std::vector<std::optional<T>> partials(num_chunks - 1);
+
+    detail::for_each_chunk(ex, num_chunks - 1, [&](std::size_t chunk)
+    {
+      I i = p.begin(first, chunk);
+      std::iter_difference_t<I> n = p.end(first, chunk) - i;
+
+      T sum = i[0];
+
+      EXECUTION_VECTORIZE_LOOP
+      for(std::iter_difference_t<I> k = 1; k < n; ++k)
+      {
+        sum = std::invoke(reduce, std::move(sum), i[k]);
+      }
+
+      partials[chunk].emplace(std::move(sum));
+    });
+
+    for(std::size_t chunk = 1; chunk < num_chunks; ++chunk)
+    {
+      std::optional<T>& carry = carries[chunk - 1];
+      std::optional<T>& partial = partials[chunk - 1];
+
+      carries[chunk].emplace(carry ? std::invoke(reduce, *carry, std::move(*partial)) : std::move(*partial));
+    }
+  }
+
+  detail::for_each_chunk(ex, num_chunks, [&](std::size_t chunk)
+  {
+    I i = p.begin(first, chunk);
+    std::iter_difference_t<I> n = p.end(first, chunk) - i;
+    O o = p.begin(d_first, chunk);
+
+    std::optional<T>& carry = carries[chunk];
+
+    T sum = carry ? std::invoke(reduce, std::move(*carry), i[0]) : T(i[0]);
+    o[0] = sum;
+
+    // each element is written after the one before it, and the scan may be in place, so this loop
+    // is not asserted to be independent. indexing it nonetheless lets the compiler see its trip count
+    for(std::iter_difference_t<I> k = 1; k < n; ++k)
+    {
+      sum = std::invoke(reduce, std::move(sum), i[k]);
+      o[k] = sum;
+    }
+  });
+
+  return p.end(d_first, num_chunks);
+}
+
+
+template<class E, class... Args>
+concept has_for_each_member_function = requires(E&& e, Args&&... args) { std::forward<E>(e).for_each(std::forward<Args>(args)...); };
+
+template<class E, class... Args>
+concept has_for_each_free_function = requires(E&& e, Args&&... args) { for_each(std::forward<E>(e), std::forward<Args>(args)...); };
+
+struct for_each_t
+{
+  template<class E, class... Args>
+    requires has_for_each_member_function<E&&,Args&&...>
+  constexpr auto operator()(E&& e, Args&&... args) const noexcept(noexcept(std::forward<E>(e).for_each(std::forward<Args>(args)...)))
+  {
+    return std::forward<E>(e).for_each(std::forward<Args>(args)...);
+  }
+
+  template<class E, class... Args>
+    requires (!has_for_each_member_function<E&&,Args&&...> and has_for_each_free_function<E&&,Args&&...>)
+  constexpr auto operator()(E&& e, Args&&... args) const noexcept(noexcept(for_each(std::forward<E>(e), std::forward<Args>(args)...)))
+  {
+    return for_each(std::forward<E>(e), std::forward<Args>(args)...);
+  }
+
+  template<executor E, std::random_access_iterator I, class F>
+    requires (!has_for_each_member_function<E&&,I&,I&,F&> and
+              !has_for_each_free_function<E&&,I&,I&,F&> and
+              invocable<F&, std::iter_reference_t<I>>
+             )
+  void operator()(E&& e, I first, I last, F f) const
+  {
+    detail::parallel_for_each(e, first, last, f);
+  }
+};
+
+
+} // end detail
+
+
+// for_each(ex, first, last, f) invokes f(*i) for each i in [first, last) upon ex
+constexpr detail::for_each_t for_each{};
+
+
+namespace detail
+{
+
+
+template<class E, class... Args>
+concept has_transform_member_function = requires(E&& e, Args&&... args) { std::forward<E>(e).transform(std::forward<Args>(args)...); };
+
+template<class E, class... Args>
+concept has_transform_free_function = requires(E&& e, Args&&... args) { transform(std::forward<E>(e), std::forward<Args>(args)...); };
+
+struct transform_t
+{
+  template<class E, class... Args>
+    requires has_transform_member_function<E&&,Args&&...>
+  constexpr auto operator()(E&& e, Args&&... args) const noexcept(noexcept(std::forward<E>(e).transform(std::forward<Args>(args)...)))
+  {
+    return std::forward<E>(e).transform(std::forward<Args>(args)...);
+  }
+
+  template<class E, class... Args>
+    requires (!has_transform_member_function<E&&,Args&&...> and has_transform_free_function<E&&,Args&&...>)
+  constexpr auto operator()(E&& e, Args&&... args) const noexcept(noexcept(transform(std::forward<E>(e), std::forward<Args>(args)...)))
+  {
+    return transform(std::forward<E>(e), std::forward<Args>(args)...);
+  }
+
+  template<executor E, std::random_access_iterator I, std::random_access_iterator O, class F>
+    requires (!has_transform_member_function<E&&,I&,I&,O&,F&> and
+              !has_transform_free_function<E&&,I&,I&,O&,F&> and
+              std::indirectly_writable<O, std::invoke_result_t<F&, std::iter_reference_t<I>>>
+             )
+  O operator()(E&& e, I first, I last, O d_first, F f) const
+  {
+    return detail::parallel_transform(e, first, last, d_first, f);
+  }
+
+  template<executor E, std::random_access_iterator I1, std::random_access_iterator I2, std::random_access_iterator O, class F>
+    requires (!has_transform_member_function<E&&,I1&,I1&,I2&,O&,F&> and
+              !has_transform_free_function<E&&,I1&,I1&,I2&,O&,F&> and
+              std::indirectly_writable<O, std::invoke_result_t<F&, std::iter_reference_t<I1>, std::iter_reference_t<I2>>>
+             )
+  O operator()(E&& e, I1 first1, I1 last1, I2 first2, O d_first, F f) const
+  {
+    return detail::parallel_transform(e, first1, last1, first2, d_first, f);
+  }
+};
+
+
+} // end detail
+
+
+// transform(ex, first, last, d_first, f) assigns f(*i) to the corresponding element of d_first for each i in [first, last) upon ex
+// transform(ex, first1, last1, first2, d_first, f) assigns f(*i1, *i2) likewise
+// both return the end of the output range
+constexpr detail::transform_t transform{};
+
+
+namespace detail
+{
+
+
+template<class E, class... Args>
+concept has_transform_reduce_member_function = requires(E&& e, Args&&... args) { std::forward<E>(e).transform_reduce(std::forward<Args>(args)...); };
+
+template<class E, class... Args>
+concept has_transform_reduce_free_function = requires(E&& e, Args&&... args) { transform_reduce(std::forward<E>(e), std::forward<Args>(args)...); };
+
+struct transform_reduce_t
+{
+  template<class E, class... Args>
+    requires has_transform_reduce_member_function<E&&,Args&&...>
+  constexpr auto operator()(E&& e, Args&&... args) const noexcept(noexcept(std::forward<E>(e).transform_reduce(std::forward<Args>(args)...)))
+  {
+    return std::forward<E>(e).transform_reduce(std::forward<Args>(args)...);
+  }
+
+  template<class E, class... Args>
+    requires (!has_transform_reduce_member_function<E&&,Args&&...> and has_transform_reduce_free_function<E&&,Args&&...>)
+  constexpr auto operator()(E&& e, Args&&... args) const noexcept(noexcept(transform_reduce(std::forward<E>(e), std::forward<Args>(args)...)))
+  {
+    return transform_reduce(std::forward<E>(e), std::forward<Args>(args)...);
+  }
+
+  template<executor E, std::random_access_iterator I, class T, class R, class U>
+    requires (!has_transform_reduce_member_function<E&&,I&,I&,T&,R&,U&> and
+              !has_transform_reduce_free_function<E&&,I&,I&,T&,R&,U&> and
+              invocable<U&, std::iter_reference_t<I>>
+             )
+  T operator()(E&& e, I first, I last, T init, R reduce, U transform) const
+  {
+    return detail::parallel_transform_reduce(e, first, last, std::move(init), reduce, transform);
+  }
+
+  template<executor E, std::random_access_iterator I1, std::random_access_iterator I2, class T, class R, class U>
+    requires (!has_transform_reduce_member_function<E&&,I1&,I1&,I2&,T&,R&,U&> and
+              !has_transform_reduce_free_function<E&&,I1&,I1&,I2&,T&,R&,U&> and
+              invocable<U&, std::iter_reference_t<I1>, std::iter_reference_t<I2>>
+             )
+  T operator()(E&& e, I1 first1, I1 last1, I2 first2, T init, R reduce, U transform) const
+  {
+    return detail::parallel_transform_reduce(e, first1, last1, first2, std::move(init), reduce, transform);
+  }
+
+  // the inner product
+  template<executor E, std::random_access_iterator I1, std::random_access_iterator I2, class T>
+    requires (!has_transform_reduce_member_function<E&&,I1&,I1&,I2&,T&> and
+              !has_transform_reduce_free_function<E&&,I1&,I1&,I2&,T&>
+             )
+  T operator()(E&& e, I1 first1, I1 last1, I2 first2, T init) const
+  {
+    std::plus<> reduce;
+    std::multiplies<> transform;
+
+    return detail::parallel_transform_reduce(e, first1, last1, first2, std::move(init), reduce, transform);
+  }
+};
+
+
+} // end detail
+
+
+// transform_reduce(ex, first, last, init, reduce, transform) reduces init and transform(*i) for each i in [first, last) with reduce upon ex
+// transform_reduce(ex, first1, last1, first2, init[, reduce, transform]) reduces init and transform(*i1, *i2) likewise,
+// and defaults to the inner product
+// reduce must be associative and commutative
+constexpr detail::transform_reduce_t transform_reduce{};
+
+
+namespace detail
+{
+
+
+template<class E, class... Args>
+concept has_inclusive_scan_member_function = requires(E&& e, Args&&... args) { std::forward<E>(e).inclusive_scan(std::forward<Args>(args)...); };
+
+template<class E, class... Args>
+concept has_inclusive_scan_free_function = requires(E&& e, Args&&... args) { inclusive_scan(std::forward<E>(e), std::forward<Args>(args)...); };
+
+struct inclusive_scan_t
+{
+  template<class E, class... Args>
+    requires has_inclusive_scan_member_function<E&&,Args&&...>
+  constexpr auto operator()(E&& e, Args&&... args) const noexcept(noexcept(std::forward<E>(e).inclusive_scan(std::forward<Args>(args)...)))
+  {
+    return std::forward<E>(e).inclusive_scan(std::forward<Args>(args)...);
+  }
+
+  template<class E, class... Args>
+    requires (!has_inclusive_scan_member_function<E&&,Args&&...> and has_inclusive_scan_free_function<E&&,Args&&...>)
+  constexpr auto operator()(E&& e, Args&&... args) const noexcept(noexcept(inclusive_scan(std::forward<E>(e), std::forward<Args>(args)...)))
+  {
+    return inclusive_scan(std::forward<E>(e), std::forward<Args>(args)...);
+  }
+
+  template<executor E, std::random_access_iterator I, std::random_access_iterator O, class R = std::plus<>>
+    requires (!has_inclusive_scan_member_function<E&&,I&,I&,O&,R&> and
+              !has_inclusive_scan_free_function<E&&,I&,I&,O&,R&> and
+              invocable<R&, std::iter_value_t<I>, std::iter_reference_t<I>>
+             )
+  O operator()(E&& e, I first, I last, O d_first, R reduce = {}) const
+  {
+    return detail::parallel_inclusive_scan<std::iter_value_t<I>>(e, first, last, d_first, reduce, std::nullopt);
+  }
+
+  template<executor E, std::random_access_iterator I, std::random_access_iterator O, class R, class T>
+    requires (!has_inclusive_scan_member_function<E&&,I&,I&,O&,R&,T&> and
+              !has_inclusive_scan_free_function<E&&,I&,I&,O&,R&,T&> and
+              invocable<R&, T, std::iter_reference_t<I>>
+             )
+  O operator()(E&& e, I first, I last, O d_first, R reduce, T init) const
+  {
+    return detail::parallel_inclusive_scan<T>(e, first, last, d_first, reduce, std::optional<T>(std::move(init)));
+  }
+};
+
+
+} // end detail
+
+
+// inclusive_scan(ex, first, last, d_first[, reduce[, init]]) assigns the reduction of init, if any, and of every element
+// up to and including *i to the corresponding element of d_first for each i in [first, last) upon ex, and returns the
+// end of the output range. reduce defaults to std::plus<> and must be associative
+constexpr detail::inclusive_scan_t inclusive_scan{};
+
+
+} // end execution
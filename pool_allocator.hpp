@@ -0,0 +1,298 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace execution
+{
+namespace detail
+{
+
+
+// thread_caching_pool hands out blocks rounded up to one of a small number of size classes
+// each thread keeps a bounded free list per size class, so once a thread's cache is warm,
+// allocating and freeing upon the same thread never reaches the global heap
+//
+// each block is preceded by a header naming the cache which allocated it. a block freed upon
+// another thread, as when an operation submitted by a producer completes upon a pool's worker,
+// is pushed onto its owner's atomic list of remote frees, which the owner drains into its free
+// lists when one runs dry. so a producer gets its blocks back rather than allocating afresh.
+// a cache outlives its thread until every block it handed out has been freed
+class thread_caching_pool
+{
+  public:
+    static constexpr std::size_t granularity = 16;
+    static constexpr std::size_t num_size_classes = 16;
+    static constexpr std::size_t max_block_size = granularity * num_size_classes;
+    static constexpr std::size_t max_cached_blocks_per_class = 256;
+
+    static void* allocate(std::size_t n)
+    {
+      if(n > max_block_size)
+      {
+        return ::operator new(n);
+      }
+
+      return cache().allocate(size_class(n));
+    }
+
+    static void deallocate(void* p, std::size_t n) noexcept
+    {
+      if(n > max_block_size)
+      {
+        ::operator delete(p);
+        return;
+      }
+
+      block* b = static_cast<block*>(p);
+      thread_cache* owner = header_of(b)->owner_;
+
+      if(owner == &cache())
+      {
+        owner->deallocate(b);
+      }
+      else
+      {
+        owner->deallocate_remote(b);
+      }
+    }
+
+  private:
+    class thread_cache;
+
+    struct block
+    {
+      block* next_;
+    };
+
+    static_assert(granularity >= sizeof(block));
+
+    // keeps the block which follows it aligned as ::operator new would
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) block_header
+    {
+      thread_cache* owner_;
+      std::size_t size_class_;
+    };
+
+    static block_header* header_of(block* b) noexcept
+    {
+      return reinterpret_cast<block_header*>(b) - 1;
+    }
+
+    struct free_list
+    {
+      block* head_ = nullptr;
+      std::size_t size_ = 0;
+    };
+
+    class thread_cache
+    {
+      public:
+        void* allocate(std::size_t size_class)
+        {
+          free_list& list = lists_[size_class];
+
+          if(!list.head_)
+          {
+            drain_remote_frees();
+          }
+
+          if(block* result = list.head_)
+          {
+            list.head_ = result->next_;
+            --list.size_;
+            ++num_outstanding_;
+            return result;
+          }
+
+          void* storage = ::operator new(sizeof(block_header) + block_size(size_class));
+          block_header* header = ::new(storage) block_header{this, size_class};
+          ++num_outstanding_;
+          return header + 1;
+        }
+
+        // requires b be freed upon the thread which owns this cache
+        void deallocate(block* b) noexcept
+        {
+          --num_outstanding_;
+          cache_or_free(b);
+        }
+
+        // may be called upon any thread
+        void deallocate_remote(block* b) noexcept
+        {
+          block* head = remote_frees_.load(std::memory_order_acquire);
+
+          do
+          {
+            if(head == abandoned())
+            {
+              // the owning thread has exited, so the block goes back to the heap
+              ::operator delete(header_of(b));
+              release_abandoned(1);
+              return;
+            }
+
+            b->next_ = head;
+          }
+          while(!remote_frees_.compare_exchange_weak(head, b, std::memory_order_release, std::memory_order_acquire));
+        }
+
+        // called as the owning thread exits. the last block freed thereafter destroys the cache
+        void abandon() noexcept
+        {
+          for(free_list& list : lists_)
+          {
+            while(list.head_)
+            {
+              ::operator delete(header_of(std::exchange(list.head_, list.head_->next_)));
+            }
+          }
+
+          // counts this thread too, so that remote frees cannot destroy the cache while it drains
+          num_abandoned_outstanding_.store(num_outstanding_ + 1, std::memory_order_relaxed);
+
+          // blocks freed remotely from here on see abandoned() and free themselves
+          block* remote = remote_frees_.exchange(abandoned(), std::memory_order_acq_rel);
+
+          std::size_t num_freed = 0;
+
+          while(remote)
+          {
+            ::operator delete(header_of(std::exchange(remote, remote->next_)));
+            ++num_freed;
+          }
+
+          release_abandoned(num_freed + 1);
+        }
+
+      private:
+        // marks remote_frees_ once the owning thread has exited
+        static block* abandoned() noexcept
+        {
+          return reinterpret_cast<block*>(alignof(block));
+        }
+
+        void release_abandoned(std::size_t n) noexcept
+        {
+          if(num_abandoned_outstanding_.fetch_sub(n, std::memory_order_acq_rel) == n)
+          {
+            delete this;
+          }
+        }
+
+        void drain_remote_frees() noexcept
+        {
+          if(!remote_frees_.load(std::memory_order_relaxed))
+          {
+            return;
+          }
+
+          block* remote = remote_frees_.exchange(nullptr, std::memory_order_acquire);
+
+          while(remote)
+          {
+            --num_outstanding_;
+            cache_or_free(std::exchange(remote, remote->next_));
+          }
+        }
+
+        void cache_or_free(block* b) noexcept
+        {
+          free_list& list = lists_[header_of(b)->size_class_];
+
+          if(list.size_ == max_cached_blocks_per_class)
+          {
+            ::operator delete(header_of(b));
+            return;
+          }
+
+          b->next_ = list.head_;
+          list.head_ = b;
+          ++list.size_;
+        }
+
+        free_list lists_[num_size_classes];
+
+        // the blocks this cache has handed out which are neither in lists_ nor drained from remote_frees_
+        std::size_t num_outstanding_ = 0;
+
+        std::atomic<block*> remote_frees_{nullptr};
+
+        // the blocks still to be freed once the owning thread has exited
+        std::atomic<std::size_t> num_abandoned_outstanding_{0};
+    };
+
+    static constexpr std::size_t size_class(std::size_t n) noexcept
+    {
+      return n == 0 ? 0 : (n - 1) / granularity;
+    }
+
+    static constexpr std::size_t block_size(std::size_t size_class) noexcept
+    {
+      return (size_class + 1) * granularity;
+    }
+
+    // the cache is allocated so that it can outlive its thread
+    struct cache_holder
+    {
+      thread_cache* cache_ = new thread_cache;
+
+      ~cache_holder()
+      {
+        cache_->abandon();
+      }
+    };
+
+    static thread_cache& cache()
+    {
+      thread_local cache_holder result;
+      return *result.cache_;
+    }
+};
+
+
+} // end detail
+
+
+// pool_allocator is a stateless allocator drawing storage from the calling thread's cache
+template<class T>
+class pool_allocator
+{
+  public:
+    using value_type = T;
+
+    pool_allocator() = default;
+
+    template<class U>
+    pool_allocator(const pool_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+      static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "pool_allocator: over-aligned types are not supported.");
+      return static_cast<T*>(detail::thread_caching_pool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+      detail::thread_caching_pool::deallocate(p, n * sizeof(T));
+    }
+
+    friend bool operator==(const pool_allocator&, const pool_allocator&) noexcept
+    {
+      return true;
+    }
+
+    friend bool operator!=(const pool_allocator&, const pool_allocator&) noexcept
+    {
+      return false;
+    }
+};
+
+
+} // end execution
+
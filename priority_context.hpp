@@ -0,0 +1,292 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include "execution.hpp"
+#include "intrusive_queue.hpp"
+#include <thread>
+#include <utility>
+
+
+// priority_context runs work on a single dedicated thread, choosing among one run queue per priority
+//
+// each priority has its own lock-free queue, so enqueueing costs the same single CAS as it does
+// on single_thread_context. the thread runs the most urgent work first, but ages the queues it
+// passes over: a non-empty queue passed over max_skips times in a row is served next, so a stream
+// of urgent work cannot starve background work
+class priority_context
+{
+  public:
+    enum class priority : std::size_t
+    {
+      background,
+      low,
+      normal,
+      high
+    };
+
+    static constexpr std::size_t num_priorities = 4;
+
+    explicit priority_context(std::size_t max_skips = 64)
+      : max_skips_(max_skips),
+        stop_task_(&priority_context::stop),
+        thread_([this]{ run(); })
+    {}
+
+    priority_context(const priority_context&) = delete;
+
+    // outstanding work is completed before the destructor returns
+    ~priority_context()
+    {
+      enqueue(&stop_task_, priority::background);
+      thread_.join();
+    }
+
+    void enqueue(detail::task_base* task, priority p = priority::normal) const noexcept
+    {
+      if(queues_[static_cast<std::size_t>(p)].queue_.push(task))
+      {
+        notify();
+      }
+    }
+
+    // enqueues num_tasks tasks with a single CAS and at most one wakeup
+    void enqueue(detail::intrusive_queue&& tasks, std::size_t, priority p = priority::normal) const noexcept
+    {
+      if(queues_[static_cast<std::size_t>(p)].queue_.push_all(std::move(tasks)))
+      {
+        notify();
+      }
+    }
+
+    std::thread::id get_id() const noexcept
+    {
+      return thread_.get_id();
+    }
+
+
+    // a task_operation enqueued with the priority of its sender
+    template<execution::receiver_of R>
+    struct operation : detail::task_operation<priority_context, R>
+    {
+      priority priority_;
+
+      template<class OtherR>
+      operation(const priority_context& context, priority p, OtherR&& r)
+        : detail::task_operation<priority_context, R>(context, std::forward<OtherR>(r)),
+          priority_(p)
+      {}
+
+      void start() noexcept
+      {
+        this->context_.enqueue(this, priority_);
+      }
+    };
+
+
+    struct sender_type
+    {
+      template<template<class...> class Tuple, template<class...> class Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template<template<class...> class Variant>
+      using error_types = Variant<execution::error_type>;
+
+      static constexpr bool sends_done = true;
+
+      const priority_context& context_;
+      priority priority_ = priority::normal;
+
+      template<execution::receiver_of R>
+      operation<R> connect(R&& r) const
+      {
+        return {context_, priority_, std::forward<R>(r)};
+      }
+
+      template<class Rs>
+        requires execution::receiver_of<execution::detail::range_value_t<Rs>>
+      void submit_batch(Rs&& receivers) const
+      {
+        using submit_receiver = execution::detail::submit_receiver<const sender_type&, execution::detail::range_value_t<Rs>>;
+
+        detail::enqueue_batch(priority_view{context_, priority_}, receivers, [this](auto&& r)
+        {
+          return &submit_receiver::make(*this, std::move(r))->state_;
+        });
+      }
+    };
+
+
+    struct executor_type
+    {
+      const priority_context* context_;
+      priority priority_ = priority::normal;
+
+      // returns an executor whose work is scheduled with priority p
+      executor_type with_priority(priority p) const noexcept
+      {
+        return {context_, p};
+      }
+
+      template<class F>
+        requires invocable<remove_cvref_t<F>&>
+      void execute(F&& f) const
+      {
+        context_->enqueue(detail::invocable_task<remove_cvref_t<F>>::make(std::forward<F>(f)), priority_);
+      }
+
+      template<class Fs>
+        requires invocable<execution::detail::range_value_t<Fs>&>
+      void execute_batch(Fs&& fs) const
+      {
+        detail::enqueue_batch(priority_view{*context_, priority_}, fs, [](auto&& f)
+        {
+          return detail::invocable_task<remove_cvref_t<decltype(f)>>::make(std::move(f));
+        });
+      }
+
+      sender_type schedule() const noexcept
+      {
+        return {*context_, priority_};
+      }
+
+      friend bool operator==(const executor_type& a, const executor_type& b)
+      {
+        return a.context_ == b.context_ and a.priority_ == b.priority_;
+      }
+
+      friend bool operator!=(const executor_type& a, const executor_type& b)
+      {
+        return !(a == b);
+      }
+    };
+
+    executor_type executor(priority p = priority::normal) const
+    {
+      return {this, p};
+    }
+
+  private:
+    // a view of the context which enqueues with a single priority, for use with detail::enqueue_batch
+    struct priority_view
+    {
+      const priority_context& context_;
+      priority priority_;
+
+      void enqueue(detail::intrusive_queue&& tasks, std::size_t num_tasks) const noexcept
+      {
+        context_.enqueue(std::move(tasks), num_tasks, priority_);
+      }
+    };
+
+    struct stop_task : detail::task_base
+    {
+      using detail::task_base::task_base;
+      bool stopped_ = false;
+    };
+
+    static void stop(detail::task_base* task) noexcept
+    {
+      static_cast<stop_task*>(task)->stopped_ = true;
+    }
+
+    // producers of different priorities do not contend for a cache line
+    struct alignas(64) shared_queue
+    {
+      detail::atomic_intrusive_queue queue_;
+    };
+
+    // the thread's own FIFO of the work taken from a shared_queue
+    struct run_queue
+    {
+      detail::intrusive_queue tasks_;
+      std::size_t num_skips_ = 0;
+    };
+
+    // called after a push finds its queue empty, and so may find the thread asleep
+    void notify() const noexcept
+    {
+      num_notifications_.fetch_add(1, std::memory_order_release);
+      num_notifications_.notify_one();
+    }
+
+    // chooses the next task to run, or returns nullptr when there is no work
+    detail::task_base* next_task() noexcept
+    {
+      for(std::size_t i = 0; i < num_priorities; ++i)
+      {
+        if(!queues_[i].queue_.empty())
+        {
+          run_queues_[i].tasks_.append(queues_[i].queue_.pop_all());
+        }
+      }
+
+      run_queue* result = nullptr;
+
+      for(std::size_t i = num_priorities; i-- > 0;)
+      {
+        run_queue& q = run_queues_[i];
+
+        if(q.tasks_.empty())
+        {
+          q.num_skips_ = 0;
+        }
+        else if(!result)
+        {
+          result = &q;
+        }
+        else if(++q.num_skips_ > max_skips_)
+        {
+          // q has waited behind more urgent work for long enough
+          result = &q;
+          break;
+        }
+      }
+
+      if(!result)
+      {
+        return nullptr;
+      }
+
+      result->num_skips_ = 0;
+      return result->tasks_.pop_front();
+    }
+
+    void run() noexcept
+    {
+      while(!stop_task_.stopped_)
+      {
+        // a notification after this load means the wait below returns immediately
+        std::uint32_t num_notifications = num_notifications_.load(std::memory_order_acquire);
+
+        if(detail::task_base* task = next_task())
+        {
+          task->execute();
+        }
+        else
+        {
+          num_notifications_.wait(num_notifications, std::memory_order_acquire);
+        }
+      }
+
+      // drain work enqueued by the tasks which ran alongside stop_task_
+      while(detail::task_base* task = next_task())
+      {
+        task->execute();
+      }
+    }
+
+    std::size_t max_skips_;
+    mutable std::array<shared_queue, num_priorities> queues_;
+    mutable std::atomic<std::uint32_t> num_notifications_{0};
+    std::array<run_queue, num_priorities> run_queues_;
+    stop_task stop_task_;
+    std::thread thread_;
+};
+
+
+static_assert(execution::executor<priority_context::executor_type>);
+static_assert(execution::scheduler<priority_context::executor_type>);
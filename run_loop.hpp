@@ -0,0 +1,202 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include "execution.hpp"
+#include "intrusive_queue.hpp"
+#include <utility>
+
+
+// run_loop is an event loop driven by whichever thread calls run()
+//
+// work posted from the thread inside run() is linked into a non-atomic local queue, while work
+// posted from other threads goes through a lock-free queue the loop drains in bulk. either way,
+// operation states embed a detail::task_base, so execution::start does not allocate
+class run_loop
+{
+  public:
+    run_loop() noexcept
+      : finish_task_(&run_loop::finish_impl)
+    {}
+
+    run_loop(const run_loop&) = delete;
+
+    // runs work until finish() has been called and no work remains
+    // only one thread may run the loop
+    void run() noexcept
+    {
+      const run_loop* enclosing_loop = std::exchange(this_thread(), this);
+
+      while(true)
+      {
+        local_queue_.append(remote_queue_.pop_all());
+
+        if(local_queue_.empty())
+        {
+          if(finish_task_.finished_)
+          {
+            break;
+          }
+
+          remote_queue_.wait();
+          continue;
+        }
+
+        // the tasks enqueued so far; those they enqueue wait for the next turn so that remote work is not starved
+        detail::intrusive_queue tasks = std::move(local_queue_);
+
+        while(detail::task_base* task = tasks.pop_front())
+        {
+          task->execute();
+        }
+      }
+
+      this_thread() = enclosing_loop;
+    }
+
+    // causes run() to return once the work posted before finish() has completed
+    // may be called from any thread, and only its first call has an effect
+    void finish() noexcept
+    {
+      if(!finish_requested_.exchange(true, std::memory_order_relaxed))
+      {
+        enqueue(&finish_task_);
+      }
+    }
+
+    void enqueue(detail::task_base* task) const noexcept
+    {
+      if(this_thread() == this)
+      {
+        local_queue_.push_back(task);
+      }
+      else if(remote_queue_.push(task))
+      {
+        remote_queue_.notify();
+      }
+    }
+
+    // enqueues num_tasks tasks with a single CAS and at most one wakeup
+    void enqueue(detail::intrusive_queue&& tasks, std::size_t) const noexcept
+    {
+      if(this_thread() == this)
+      {
+        local_queue_.append(std::move(tasks));
+      }
+      else if(remote_queue_.push_all(std::move(tasks)))
+      {
+        remote_queue_.notify();
+      }
+    }
+
+
+    template<execution::receiver_of R>
+    using operation = detail::task_operation<run_loop, R>;
+
+
+    struct sender_type
+    {
+      template<template<class...> class Tuple, template<class...> class Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template<template<class...> class Variant>
+      using error_types = Variant<execution::error_type>;
+
+      static constexpr bool sends_done = true;
+
+      const run_loop& loop_;
+
+      template<execution::receiver_of R>
+      operation<R> connect(R&& r) const
+      {
+        return {loop_, std::forward<R>(r)};
+      }
+
+      template<class Rs>
+        requires execution::receiver_of<execution::detail::range_value_t<Rs>>
+      void submit_batch(Rs&& receivers) const
+      {
+        using submit_receiver = execution::detail::submit_receiver<const sender_type&, execution::detail::range_value_t<Rs>>;
+
+        detail::enqueue_batch(loop_, receivers, [this](auto&& r)
+        {
+          return &submit_receiver::make(*this, std::move(r))->state_;
+        });
+      }
+    };
+
+
+    struct scheduler_type
+    {
+      const run_loop* loop_;
+
+      template<class F>
+        requires invocable<remove_cvref_t<F>&>
+      void execute(F&& f) const
+      {
+        loop_->enqueue(detail::invocable_task<remove_cvref_t<F>>::make(std::forward<F>(f)));
+      }
+
+      template<class Fs>
+        requires invocable<execution::detail::range_value_t<Fs>&>
+      void execute_batch(Fs&& fs) const
+      {
+        detail::enqueue_batch(*loop_, fs, [](auto&& f)
+        {
+          return detail::invocable_task<remove_cvref_t<decltype(f)>>::make(std::move(f));
+        });
+      }
+
+      sender_type schedule() const noexcept
+      {
+        return {*loop_};
+      }
+
+      friend bool operator==(const scheduler_type& a, const scheduler_type& b)
+      {
+        return a.loop_ == b.loop_;
+      }
+
+      friend bool operator!=(const scheduler_type& a, const scheduler_type& b)
+      {
+        return !(a == b);
+      }
+    };
+
+    scheduler_type scheduler() const
+    {
+      return {this};
+    }
+
+  private:
+    struct finish_task : detail::task_base
+    {
+      using detail::task_base::task_base;
+      bool finished_ = false;
+    };
+
+    static void finish_impl(detail::task_base* task) noexcept
+    {
+      static_cast<finish_task*>(task)->finished_ = true;
+    }
+
+    // identifies the loop, if any, being run by the current thread
+    static const run_loop*& this_thread() noexcept
+    {
+      thread_local const run_loop* result = nullptr;
+      return result;
+    }
+
+    mutable detail::atomic_intrusive_queue remote_queue_;
+
+    // only touched by the thread inside run()
+    mutable detail::intrusive_queue local_queue_;
+
+    std::atomic<bool> finish_requested_{false};
+    finish_task finish_task_;
+};
+
+
+static_assert(execution::executor<run_loop::scheduler_type>);
+static_assert(execution::scheduler<run_loop::scheduler_type>);
@@ -0,0 +1,1407 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include "execution.hpp"
+#include <functional>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+
+namespace execution
+{
+namespace detail
+{
+
+
+// type lists compute the value_types and error_types of adapted senders
+template<class... Ts>
+struct type_list {};
+
+
+template<class List, class... Ts>
+struct type_list_push_unique
+{
+  using type = List;
+};
+
+template<class... Us, class T, class... Ts>
+struct type_list_push_unique<type_list<Us...>, T, Ts...>
+  : type_list_push_unique<
+      std::conditional_t<(std::is_same_v<Us,T> or ...), type_list<Us...>, type_list<Us...,T>>,
+      Ts...
+    >
+{};
+
+
+// concatenates type_lists, dropping duplicate elements
+template<class Result, class... Lists>
+struct type_list_union_impl
+{
+  using type = Result;
+};
+
+template<class Result, class... Ts, class... Lists>
+struct type_list_union_impl<Result, type_list<Ts...>, Lists...>
+  : type_list_union_impl<typename type_list_push_unique<Result, Ts...>::type, Lists...>
+{};
+
+template<class... Lists>
+using type_list_union_t = typename type_list_union_impl<type_list<>, Lists...>::type;
+
+
+// concatenates type_lists, keeping duplicate elements
+template<class... Lists>
+struct type_list_concat;
+
+template<>
+struct type_list_concat<>
+{
+  using type = type_list<>;
+};
+
+template<class... Ts>
+struct type_list_concat<type_list<Ts...>>
+{
+  using type = type_list<Ts...>;
+};
+
+template<class... Ts, class... Us, class... Lists>
+struct type_list_concat<type_list<Ts...>, type_list<Us...>, Lists...>
+  : type_list_concat<type_list<Ts...,Us...>, Lists...>
+{};
+
+template<class... Lists>
+using type_list_concat_t = typename type_list_concat<Lists...>::type;
+
+
+// replaces each element T of a type_list with Transform<T>
+template<template<class> class Transform, class List>
+struct type_list_transform;
+
+template<template<class> class Transform, class... Ts>
+struct type_list_transform<Transform, type_list<Ts...>>
+{
+  using type = type_list<Transform<Ts>...>;
+};
+
+template<template<class> class Transform, class List>
+using type_list_transform_t = typename type_list_transform<Transform, List>::type;
+
+
+template<template<class...> class T, class List>
+struct type_list_apply;
+
+template<template<class...> class T, class... Ts>
+struct type_list_apply<T, type_list<Ts...>>
+{
+  using type = T<Ts...>;
+};
+
+template<template<class...> class T, class List>
+using type_list_apply_t = typename type_list_apply<T, List>::type;
+
+
+// a type_list of type_lists, one for each way S may call set_value
+template<class S>
+using value_type_lists_t = typename sender_traits<remove_cvref_t<S>>::template value_types<type_list, type_list>;
+
+template<class S>
+using error_type_list_t = typename sender_traits<remove_cvref_t<S>>::template error_types<type_list>;
+
+
+template<class List>
+struct decayed_type_list;
+
+template<class... Ts>
+struct decayed_type_list<type_list<Ts...>>
+{
+  using type = type_list<std::decay_t<Ts>...>;
+};
+
+template<class List>
+using decayed_type_list_t = typename decayed_type_list<List>::type;
+
+
+template<class List>
+using tuple_of_type_list_t = type_list_apply_t<std::tuple, List>;
+
+// the type_lists of the values a sender sends, as an adaptor stores them
+template<class S>
+using decayed_value_type_lists_t = type_list_union_t<
+  type_list_transform_t<
+    decayed_type_list_t,
+    value_type_lists_t<S>
+  >
+>;
+
+
+template<class Lists, template<class...> class Tuple, template<class...> class Variant>
+struct value_types_from_lists;
+
+template<class... Lists, template<class...> class Tuple, template<class...> class Variant>
+struct value_types_from_lists<type_list<Lists...>, Tuple, Variant>
+{
+  using type = Variant<type_list_apply_t<Tuple, Lists>...>;
+};
+
+
+// the std::variant of std::tuples in which an adaptor stores the values sent by S
+template<class S>
+using stored_values_t = type_list_apply_t<
+  std::variant,
+  type_list_concat_t<
+    type_list<std::monostate>,
+    type_list_transform_t<
+      tuple_of_type_list_t,
+      decayed_value_type_lists_t<S>
+    >
+  >
+>;
+
+
+// storage for an operation state whose type is one of Ops, chosen when it is constructed
+// operation states may be neither copyable nor movable, so they are constructed in place
+// from the prvalue returned by make()
+template<class... Ops>
+class operation_storage
+{
+  public:
+    operation_storage() = default;
+
+    operation_storage(const operation_storage&) = delete;
+
+    ~operation_storage()
+    {
+      reset();
+    }
+
+    template<class Op, class F>
+    Op& emplace(F&& make)
+    {
+      reset();
+
+      Op* result = ::new(static_cast<void*>(storage_)) Op(std::invoke(std::forward<F>(make)));
+
+      destroy_ = [](void* p) noexcept
+      {
+        static_cast<Op*>(p)->~Op();
+      };
+
+      return *result;
+    }
+
+    void reset() noexcept
+    {
+      if(destroy_)
+      {
+        destroy_(storage_);
+        destroy_ = nullptr;
+      }
+    }
+
+  private:
+    alignas(Ops...) unsigned char storage_[std::max({std::size_t(1), sizeof(Ops)...})];
+    void (*destroy_)(void*) noexcept = nullptr;
+};
+
+
+// true if the values As... are stored by an adaptor of S
+template<class T, class Variant>
+struct is_variant_alternative;
+
+template<class T, class... Ts>
+struct is_variant_alternative<T, std::variant<Ts...>> : std::bool_constant<(std::is_same_v<T,Ts> or ...)> {};
+
+template<class S, class... As>
+concept stores_values_of = is_variant_alternative<std::tuple<std::decay_t<As>...>, stored_values_t<S>>::value;
+
+
+template<class List>
+struct operation_storage_of;
+
+template<class... Ops>
+struct operation_storage_of<type_list<Ops...>>
+{
+  using type = operation_storage<Ops...>;
+};
+
+
+// forwards every signal and query to a receiver owned by an enclosing operation state
+template<class R>
+struct ref_receiver
+{
+  R* r_;
+
+  template<class... As>
+    requires receiver_of<R, As...>
+  void set_value(As&&... as) && noexcept(is_nothrow_receiver_of_v<R, As...>)
+  {
+    execution::set_value(std::move(*r_), std::forward<As>(as)...);
+  }
+
+  template<class E>
+    requires receiver<R,E>
+  void set_error(E&& e) && noexcept
+  {
+    execution::set_error(std::move(*r_), std::forward<E>(e));
+  }
+
+  void set_done() && noexcept
+  {
+    execution::set_done(std::move(*r_));
+  }
+
+  auto get_stop_token() const noexcept
+  {
+    return execution::get_stop_token(*r_);
+  }
+
+  auto get_allocator() const noexcept
+  {
+    return execution::get_allocator(*r_);
+  }
+};
+
+
+} // end detail
+
+
+namespace detail
+{
+
+
+template<class F, class List>
+struct then_value_type_list;
+
+template<class F, class... Ts>
+struct then_value_type_list<F, type_list<Ts...>>
+{
+  using result_type = std::invoke_result_t<F, Ts...>;
+
+  using type = std::conditional_t<
+    std::is_void_v<result_type>,
+    type_list<type_list<>>,
+    type_list<type_list<result_type>>
+  >;
+};
+
+
+template<class F, class Lists>
+struct then_value_type_lists;
+
+template<class F, class... Lists>
+struct then_value_type_lists<F, type_list<Lists...>>
+{
+  using type = type_list_union_t<typename then_value_type_list<F, Lists>::type...>;
+};
+
+
+// then_receiver completes R with the result of invoking F with the values it receives
+// the receiver is passed down to the predecessor's connect, so a chain of thens fuses
+// into the single operation state of the chain's first sender
+template<class R, class F>
+struct then_receiver
+{
+  R r_;
+  F f_;
+
+  template<class... As>
+    requires invocable<F, As...>
+  void set_value(As&&... as) && noexcept
+  {
+    detail::invoke_or_set_error(r_, [&]
+    {
+      if constexpr(std::is_void_v<std::invoke_result_t<F, As...>>)
+      {
+        std::invoke(std::move(f_), std::forward<As>(as)...);
+        execution::set_value(std::move(r_));
+      }
+      else
+      {
+        execution::set_value(std::move(r_), std::invoke(std::move(f_), std::forward<As>(as)...));
+      }
+    });
+  }
+
+  template<class E>
+    requires receiver<R,E>
+  void set_error(E&& e) && noexcept
+  {
+    execution::set_error(std::move(r_), std::forward<E>(e));
+  }
+
+  void set_done() && noexcept
+  {
+    execution::set_done(std::move(r_));
+  }
+
+  auto get_stop_token() const noexcept
+  {
+    return execution::get_stop_token(r_);
+  }
+
+  auto get_allocator() const noexcept
+  {
+    return execution::get_allocator(r_);
+  }
+};
+
+
+template<class S, class F>
+struct then_sender
+{
+  template<template<class...> class Tuple, template<class...> class Variant>
+  using value_types = typename value_types_from_lists<
+    typename then_value_type_lists<F, value_type_lists_t<S>>::type,
+    Tuple,
+    Variant
+  >::type;
+
+  template<template<class...> class Variant>
+  using error_types = type_list_apply_t<
+    Variant,
+    type_list_union_t<error_type_list_t<S>, type_list<error_type>>
+  >;
+
+  static constexpr bool sends_done = sender_traits<S>::sends_done;
+
+  S sender_;
+  F f_;
+
+  template<receiver R>
+  connect_result_t<S, then_receiver<remove_cvref_t<R>, F>> connect(R&& r) &&
+  {
+    return execution::connect(std::move(sender_), then_receiver<remove_cvref_t<R>, F>{std::forward<R>(r), std::move(f_)});
+  }
+
+  template<receiver R>
+  connect_result_t<const S&, then_receiver<remove_cvref_t<R>, F>> connect(R&& r) const &
+  {
+    return execution::connect(sender_, then_receiver<remove_cvref_t<R>, F>{std::forward<R>(r), f_});
+  }
+};
+
+
+template<class S, class F>
+concept has_then_member_function = requires(S&& s, F&& f) { std::forward<S>(s).then(std::forward<F>(f)); };
+
+template<class S, class F>
+concept has_then_free_function = requires(S&& s, F&& f) { then(std::forward<S>(s), std::forward<F>(f)); };
+
+struct then_t
+{
+  template<class S, class F>
+    requires has_then_member_function<S&&,F&&>
+  constexpr sender auto operator()(S&& s, F&& f) const noexcept(noexcept(std::forward<S>(s).then(std::forward<F>(f))))
+  {
+    return std::forward<S>(s).then(std::forward<F>(f));
+  }
+
+  template<class S, class F>
+    requires (!has_then_member_function<S&&,F&&> and has_then_free_function<S&&,F&&>)
+  constexpr sender auto operator()(S&& s, F&& f) const noexcept(noexcept(then(std::forward<S>(s), std::forward<F>(f))))
+  {
+    return then(std::forward<S>(s), std::forward<F>(f));
+  }
+
+  template<sender S, class F>
+    requires (!has_then_member_function<S&&,F&&> and !has_then_free_function<S&&,F&&>)
+  constexpr sender auto operator()(S&& s, F&& f) const
+  {
+    return then_sender<remove_cvref_t<S>, std::decay_t<F>>{std::forward<S>(s), std::forward<F>(f)};
+  }
+};
+
+
+} // end detail
+
+
+// then(s, f) sends the result of invoking f with the values sent by s
+constexpr detail::then_t then{};
+
+
+namespace detail
+{
+
+
+template<class F>
+struct let_value_successor
+{
+  template<class List>
+  struct of;
+
+  template<class... Ts>
+  struct of<type_list<Ts...>>
+  {
+    using type = remove_cvref_t<std::invoke_result_t<F&, Ts&...>>;
+  };
+
+  template<class List>
+  using type = typename of<List>::type;
+};
+
+
+// the senders f may return given the values sent by S
+template<class S, class F>
+using let_value_successors_t = type_list_transform_t<
+  let_value_successor<F>::template type,
+  decayed_value_type_lists_t<S>
+>;
+
+
+template<class R>
+struct let_value_successor_operation
+{
+  template<class S>
+  using type = connect_result_t<S, ref_receiver<R>>;
+};
+
+
+template<class S, class F, class R>
+class let_value_operation
+{
+  private:
+    struct predecessor_receiver
+    {
+      let_value_operation* op_;
+
+      template<class... As>
+        requires stores_values_of<S, As...>
+      void set_value(As&&... as) && noexcept
+      {
+        op_->start_successor(std::forward<As>(as)...);
+      }
+
+      template<class E>
+        requires receiver<R,E>
+      void set_error(E&& e) && noexcept
+      {
+        execution::set_error(std::move(op_->receiver_), std::forward<E>(e));
+      }
+
+      void set_done() && noexcept
+      {
+        execution::set_done(std::move(op_->receiver_));
+      }
+
+      auto get_stop_token() const noexcept
+      {
+        return execution::get_stop_token(op_->receiver_);
+      }
+
+      auto get_allocator() const noexcept
+      {
+        return execution::get_allocator(op_->receiver_);
+      }
+    };
+
+    using successor_storage_type = typename operation_storage_of<
+      type_list_transform_t<
+        let_value_successor_operation<R>::template type,
+        let_value_successors_t<S,F>
+      >
+    >::type;
+
+    template<class... As>
+    void start_successor(As&&... as) noexcept
+    {
+      detail::invoke_or_set_error(receiver_, [&]
+      {
+        auto& values = values_.template emplace<std::tuple<std::decay_t<As>...>>(std::forward<As>(as)...);
+
+        std::apply([this](auto&... vs)
+        {
+          using sender_type = remove_cvref_t<std::invoke_result_t<F&, decltype(vs)...>>;
+          using operation_type = connect_result_t<sender_type, ref_receiver<R>>;
+
+          operation_type& op = successor_.template emplace<operation_type>([&]
+          {
+            return execution::connect(std::invoke(f_, vs...), ref_receiver<R>{&receiver_});
+          });
+
+          execution::start(op);
+        }, values);
+      });
+    }
+
+    R receiver_;
+    F f_;
+    stored_values_t<S> values_;
+    successor_storage_type successor_;
+    connect_result_t<S, predecessor_receiver> predecessor_;
+
+  public:
+    template<class OtherS, class OtherF, class OtherR>
+    let_value_operation(OtherS&& s, OtherF&& f, OtherR&& r)
+      : receiver_(std::forward<OtherR>(r)),
+        f_(std::forward<OtherF>(f)),
+        predecessor_(execution::connect(std::forward<OtherS>(s), predecessor_receiver{this}))
+    {}
+
+    // the predecessor's receiver refers to this object, so it must not move
+    let_value_operation(let_value_operation&&) = delete;
+
+    void start() noexcept
+    {
+      execution::start(predecessor_);
+    }
+};
+
+
+template<class List>
+struct any_sends_done;
+
+template<class... Ss>
+struct any_sends_done<type_list<Ss...>> : std::bool_constant<(sender_traits<Ss>::sends_done or ...)> {};
+
+
+template<class S, class F>
+struct let_value_sender
+{
+  private:
+    using successors = let_value_successors_t<S,F>;
+
+    template<class Successor>
+    using successor_value_type_lists = value_type_lists_t<Successor>;
+
+    template<class Successor>
+    using successor_error_type_list = error_type_list_t<Successor>;
+
+  public:
+    template<template<class...> class Tuple, template<class...> class Variant>
+    using value_types = typename value_types_from_lists<
+      type_list_apply_t<
+        type_list_union_t,
+        type_list_transform_t<successor_value_type_lists, successors>
+      >,
+      Tuple,
+      Variant
+    >::type;
+
+    template<template<class...> class Variant>
+    using error_types = type_list_apply_t<
+      Variant,
+      type_list_apply_t<
+        type_list_union_t,
+        type_list_concat_t<
+          type_list<error_type_list_t<S>>,
+          type_list_transform_t<successor_error_type_list, successors>,
+          type_list<type_list<error_type>>
+        >
+      >
+    >;
+
+    static constexpr bool sends_done = sender_traits<S>::sends_done or any_sends_done<successors>::value;
+
+    S sender_;
+    F f_;
+
+    template<receiver R>
+    let_value_operation<S, F, remove_cvref_t<R>> connect(R&& r) &&
+    {
+      return {std::move(sender_), std::move(f_), std::forward<R>(r)};
+    }
+
+    template<receiver R>
+    let_value_operation<const S&, F, remove_cvref_t<R>> connect(R&& r) const &
+    {
+      return {sender_, f_, std::forward<R>(r)};
+    }
+};
+
+
+template<class S, class F>
+concept has_let_value_member_function = requires(S&& s, F&& f) { std::forward<S>(s).let_value(std::forward<F>(f)); };
+
+template<class S, class F>
+concept has_let_value_free_function = requires(S&& s, F&& f) { let_value(std::forward<S>(s), std::forward<F>(f)); };
+
+struct let_value_t
+{
+  template<class S, class F>
+    requires has_let_value_member_function<S&&,F&&>
+  constexpr sender auto operator()(S&& s, F&& f) const noexcept(noexcept(std::forward<S>(s).let_value(std::forward<F>(f))))
+  {
+    return std::forward<S>(s).let_value(std::forward<F>(f));
+  }
+
+  template<class S, class F>
+    requires (!has_let_value_member_function<S&&,F&&> and has_let_value_free_function<S&&,F&&>)
+  constexpr sender auto operator()(S&& s, F&& f) const noexcept(noexcept(let_value(std::forward<S>(s), std::forward<F>(f))))
+  {
+    return let_value(std::forward<S>(s), std::forward<F>(f));
+  }
+
+  template<sender S, class F>
+    requires (!has_let_value_member_function<S&&,F&&> and !has_let_value_free_function<S&&,F&&>)
+  constexpr sender auto operator()(S&& s, F&& f) const
+  {
+    return let_value_sender<remove_cvref_t<S>, std::decay_t<F>>{std::forward<S>(s), std::forward<F>(f)};
+  }
+};
+
+
+} // end detail
+
+
+// let_value(s, f) sends what the sender returned by invoking f with the values sent by s sends
+// the values live in the operation state until that sender completes, and f receives them as lvalues
+constexpr detail::let_value_t let_value{};
+
+
+namespace detail
+{
+
+
+template<class List>
+struct type_list_size;
+
+template<class... Ts>
+struct type_list_size<type_list<Ts...>> : std::integral_constant<std::size_t, sizeof...(Ts)> {};
+
+
+template<class S>
+concept single_value_sender = type_list_size<value_type_lists_t<S>>::value == 1;
+
+
+// the std::tuple in which when_all stores the values sent by S
+template<class S>
+using when_all_values_t = type_list_apply_t<std::tuple, type_list_apply_t<type_list_concat_t, decayed_value_type_lists_t<S>>>;
+
+
+template<class Op, std::size_t I>
+struct when_all_receiver
+{
+  Op* op_;
+
+  template<class... As>
+  void set_value(As&&... as) && noexcept
+  {
+    op_->template set_child_value<I>(std::forward<As>(as)...);
+  }
+
+  template<class E>
+  void set_error(E&& e) && noexcept
+  {
+    op_->set_child_error(std::forward<E>(e));
+  }
+
+  void set_done() && noexcept
+  {
+    op_->set_child_done();
+  }
+
+  in_place_stop_token get_stop_token() const noexcept
+  {
+    return op_->stop_source_.get_token();
+  }
+};
+
+
+template<class Op, std::size_t I, class S>
+struct when_all_child
+{
+  connect_result_t<S, when_all_receiver<Op,I>> op_;
+
+  template<class OtherS>
+  when_all_child(OtherS&& s, Op* op)
+    : op_(execution::connect(std::forward<OtherS>(s), when_all_receiver<Op,I>{op}))
+  {}
+};
+
+
+template<class Op, class Indices, class... Ss>
+struct when_all_children;
+
+template<class Op, std::size_t... Is, class... Ss>
+struct when_all_children<Op, std::index_sequence<Is...>, Ss...> : when_all_child<Op, Is, Ss>...
+{
+  template<class... OtherSs>
+  when_all_children(Op* op, OtherSs&&... ss)
+    : when_all_child<Op, Is, Ss>(std::forward<OtherSs>(ss), op)...
+  {}
+
+  void start() noexcept
+  {
+    (execution::start(when_all_child<Op, Is, Ss>::op_), ...);
+  }
+};
+
+
+// when_all_operation starts every child at once and completes its receiver once all have completed
+//
+// the first child to complete with set_error or set_done requests stop on the others, and that
+// signal becomes the result. a stop request on the receiver's stop token is forwarded to the children
+template<class R, class... Ss>
+class when_all_operation
+{
+  private:
+    template<class, std::size_t>
+    friend struct when_all_receiver;
+
+    enum class state_type : int { running, error, done };
+
+    struct forward_stop
+    {
+      when_all_operation* op_;
+
+      void operator()() const noexcept
+      {
+        op_->forward_stop_request();
+      }
+    };
+
+    using stop_callback_type = typename stop_token_of_t<R>::template callback_type<forward_stop>;
+
+    using error_type = type_list_apply_t<
+      std::variant,
+      type_list_concat_t<
+        type_list<std::monostate>,
+        type_list_transform_t<std::decay_t, type_list_union_t<error_type_list_t<Ss>..., type_list<execution::error_type>>>
+      >
+    >;
+
+    template<std::size_t I, class... As>
+    void set_child_value(As&&... as) noexcept
+    {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+      std::get<I>(values_).emplace(std::forward<As>(as)...);
+#else
+      try
+      {
+        std::get<I>(values_).emplace(std::forward<As>(as)...);
+      }
+      catch(...)
+      {
+        set_child_error(std::current_exception());
+        return;
+      }
+#endif
+
+      arrive();
+    }
+
+    template<class E>
+    void set_child_error(E&& e) noexcept
+    {
+      state_type expected = state_type::running;
+
+      if(state_.compare_exchange_strong(expected, state_type::error, std::memory_order_relaxed))
+      {
+        error_.template emplace<std::decay_t<E>>(std::forward<E>(e));
+        stop_source_.request_stop();
+      }
+
+      arrive();
+    }
+
+    void set_child_done() noexcept
+    {
+      state_type expected = state_type::running;
+
+      if(state_.compare_exchange_strong(expected, state_type::done, std::memory_order_relaxed))
+      {
+        stop_source_.request_stop();
+      }
+
+      arrive();
+    }
+
+    // a child may complete inside the stop callback which request_stop runs, so the forwarded request
+    // holds a count of its own: otherwise, the last child to arrive could complete the receiver, which may
+    // destroy this object before request_stop returns. no count remains once complete has begun, and it
+    // waits for this callback to return before it proceeds
+    void forward_stop_request() noexcept
+    {
+      std::size_t n = num_outstanding_.load(std::memory_order_relaxed);
+
+      do
+      {
+        if(n == 0)
+        {
+          return;
+        }
+      }
+      while(!num_outstanding_.compare_exchange_weak(n, n + 1, std::memory_order_acquire, std::memory_order_relaxed));
+
+      stop_source_.request_stop();
+      arrive();
+    }
+
+    void arrive() noexcept
+    {
+      if(num_outstanding_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        complete();
+      }
+    }
+
+    void complete() noexcept
+    {
+      stop_callback_.reset();
+
+      switch(state_.load(std::memory_order_relaxed))
+      {
+        case state_type::running:
+        {
+          detail::invoke_or_set_error(receiver_, [this]
+          {
+            std::apply([this](auto&... values)
+            {
+              std::apply([this](auto&&... vs)
+              {
+                execution::set_value(std::move(receiver_), std::move(vs)...);
+              }, std::tuple_cat(std::move(*values)...));
+            }, values_);
+          });
+
+          break;
+        }
+
+        case state_type::error:
+        {
+          std::visit([this](auto& e)
+          {
+            if constexpr(!std::is_same_v<std::monostate, remove_cvref_t<decltype(e)>>)
+            {
+              execution::set_error(std::move(receiver_), std::move(e));
+            }
+          }, error_);
+
+          break;
+        }
+
+        case state_type::done:
+        {
+          execution::set_done(std::move(receiver_));
+          break;
+        }
+      }
+    }
+
+    R receiver_;
+    std::tuple<std::optional<when_all_values_t<Ss>>...> values_;
+    error_type error_;
+    std::atomic<state_type> state_{state_type::running};
+    std::atomic<std::size_t> num_outstanding_{sizeof...(Ss)};
+    in_place_stop_source stop_source_;
+    std::optional<stop_callback_type> stop_callback_;
+    when_all_children<when_all_operation, std::index_sequence_for<Ss...>, Ss...> children_;
+
+  public:
+    template<class OtherR, class... OtherSs>
+    when_all_operation(OtherR&& r, OtherSs&&... ss)
+      : receiver_(std::forward<OtherR>(r)),
+        children_(this, std::forward<OtherSs>(ss)...)
+    {}
+
+    // children's receivers refer to this object, so it must not move
+    when_all_operation(when_all_operation&&) = delete;
+
+    void start() noexcept
+    {
+      stop_callback_.emplace(execution::get_stop_token(receiver_), forward_stop{this});
+      children_.start();
+    }
+};
+
+
+template<class... Ss>
+struct when_all_sender
+{
+  template<template<class...> class Tuple, template<class...> class Variant>
+  using value_types = Variant<
+    type_list_apply_t<
+      Tuple,
+      type_list_concat_t<type_list_apply_t<type_list_concat_t, decayed_value_type_lists_t<Ss>>...>
+    >
+  >;
+
+  template<template<class...> class Variant>
+  using error_types = type_list_apply_t<
+    Variant,
+    type_list_transform_t<std::decay_t, type_list_union_t<error_type_list_t<Ss>..., type_list<error_type>>>
+  >;
+
+  static constexpr bool sends_done = true;
+
+  std::tuple<Ss...> senders_;
+
+  template<receiver R>
+  when_all_operation<remove_cvref_t<R>, Ss...> connect(R&& r) &&
+  {
+    return std::apply([&](Ss&... ss) -> when_all_operation<remove_cvref_t<R>, Ss...>
+    {
+      return {std::forward<R>(r), std::move(ss)...};
+    }, senders_);
+  }
+
+  template<receiver R>
+  when_all_operation<remove_cvref_t<R>, const Ss&...> connect(R&& r) const &
+  {
+    return std::apply([&](const Ss&... ss) -> when_all_operation<remove_cvref_t<R>, const Ss&...>
+    {
+      return {std::forward<R>(r), ss...};
+    }, senders_);
+  }
+};
+
+
+template<class... Ss>
+concept has_when_all_free_function = requires(Ss&&... ss) { when_all(std::forward<Ss>(ss)...); };
+
+struct when_all_t
+{
+  template<class... Ss>
+    requires has_when_all_free_function<Ss&&...>
+  constexpr sender auto operator()(Ss&&... ss) const noexcept(noexcept(when_all(std::forward<Ss>(ss)...)))
+  {
+    return when_all(std::forward<Ss>(ss)...);
+  }
+
+  template<sender... Ss>
+    requires (sizeof...(Ss) > 0 and !has_when_all_free_function<Ss&&...> and (single_value_sender<Ss> and ...))
+  constexpr sender auto operator()(Ss&&... ss) const
+  {
+    return when_all_sender<remove_cvref_t<Ss>...>{{std::forward<Ss>(ss)...}};
+  }
+};
+
+
+} // end detail
+
+
+// when_all(s...) sends the values sent by every s, concatenated in order
+// each s must send a single set of values
+constexpr detail::when_all_t when_all{};
+
+
+namespace detail
+{
+
+
+template<class S, class Sch, class R>
+class transfer_operation
+{
+  private:
+    struct predecessor_receiver
+    {
+      transfer_operation* op_;
+
+      template<class... As>
+        requires stores_values_of<S, As...>
+      void set_value(As&&... as) && noexcept
+      {
+        op_->schedule_values(std::forward<As>(as)...);
+      }
+
+      template<class E>
+        requires receiver<R,E>
+      void set_error(E&& e) && noexcept
+      {
+        execution::set_error(std::move(op_->receiver_), std::forward<E>(e));
+      }
+
+      void set_done() && noexcept
+      {
+        execution::set_done(std::move(op_->receiver_));
+      }
+
+      auto get_stop_token() const noexcept
+      {
+        return execution::get_stop_token(op_->receiver_);
+      }
+
+      auto get_allocator() const noexcept
+      {
+        return execution::get_allocator(op_->receiver_);
+      }
+    };
+
+    struct schedule_receiver
+    {
+      transfer_operation* op_;
+
+      void set_value() && noexcept
+      {
+        op_->send_values();
+      }
+
+      template<class E>
+        requires receiver<R,E>
+      void set_error(E&& e) && noexcept
+      {
+        execution::set_error(std::move(op_->receiver_), std::forward<E>(e));
+      }
+
+      void set_done() && noexcept
+      {
+        execution::set_done(std::move(op_->receiver_));
+      }
+
+      auto get_stop_token() const noexcept
+      {
+        return execution::get_stop_token(op_->receiver_);
+      }
+
+      auto get_allocator() const noexcept
+      {
+        return execution::get_allocator(op_->receiver_);
+      }
+    };
+
+    using schedule_operation_type = connect_result_t<std::invoke_result_t<decltype(execution::schedule), Sch&>, schedule_receiver>;
+
+    template<class... As>
+    void schedule_values(As&&... as) noexcept
+    {
+      detail::invoke_or_set_error(receiver_, [&]
+      {
+        values_.template emplace<std::tuple<std::decay_t<As>...>>(std::forward<As>(as)...);
+
+        schedule_operation_type& op = schedule_operation_.template emplace<schedule_operation_type>([this]
+        {
+          return execution::connect(execution::schedule(scheduler_), schedule_receiver{this});
+        });
+
+        execution::start(op);
+      });
+    }
+
+    void send_values() noexcept
+    {
+      detail::invoke_or_set_error(receiver_, [this]
+      {
+        std::visit([this](auto& values)
+        {
+          if constexpr(!std::is_same_v<std::monostate, remove_cvref_t<decltype(values)>>)
+          {
+            std::apply([this](auto&... vs)
+            {
+              execution::set_value(std::move(receiver_), std::move(vs)...);
+            }, values);
+          }
+        }, values_);
+      });
+    }
+
+    R receiver_;
+    Sch scheduler_;
+    stored_values_t<S> values_;
+    operation_storage<schedule_operation_type> schedule_operation_;
+    connect_result_t<S, predecessor_receiver> predecessor_;
+
+  public:
+    template<class OtherS, class OtherSch, class OtherR>
+    transfer_operation(OtherS&& s, OtherSch&& sch, OtherR&& r)
+      : receiver_(std::forward<OtherR>(r)),
+        scheduler_(std::forward<OtherSch>(sch)),
+        predecessor_(execution::connect(std::forward<OtherS>(s), predecessor_receiver{this}))
+    {}
+
+    // the predecessor's receiver refers to this object, so it must not move
+    transfer_operation(transfer_operation&&) = delete;
+
+    void start() noexcept
+    {
+      execution::start(predecessor_);
+    }
+};
+
+
+template<class S, class Sch>
+struct transfer_sender
+{
+  private:
+    using schedule_sender_type = remove_cvref_t<std::invoke_result_t<decltype(execution::schedule), Sch&>>;
+
+  public:
+    template<template<class...> class Tuple, template<class...> class Variant>
+    using value_types = typename value_types_from_lists<decayed_value_type_lists_t<S>, Tuple, Variant>::type;
+
+    template<template<class...> class Variant>
+    using error_types = type_list_apply_t<
+      Variant,
+      type_list_union_t<error_type_list_t<S>, error_type_list_t<schedule_sender_type>, type_list<error_type>>
+    >;
+
+    static constexpr bool sends_done = sender_traits<S>::sends_done or sender_traits<schedule_sender_type>::sends_done;
+
+    S sender_;
+    Sch scheduler_;
+
+    template<receiver R>
+    transfer_operation<S, Sch, remove_cvref_t<R>> connect(R&& r) &&
+    {
+      return {std::move(sender_), std::move(scheduler_), std::forward<R>(r)};
+    }
+
+    template<receiver R>
+    transfer_operation<const S&, Sch, remove_cvref_t<R>> connect(R&& r) const &
+    {
+      return {sender_, scheduler_, std::forward<R>(r)};
+    }
+};
+
+
+template<class S, class Sch>
+concept has_transfer_member_function = requires(S&& s, Sch&& sch) { std::forward<S>(s).transfer(std::forward<Sch>(sch)); };
+
+template<class S, class Sch>
+concept has_transfer_free_function = requires(S&& s, Sch&& sch) { transfer(std::forward<S>(s), std::forward<Sch>(sch)); };
+
+struct transfer_t
+{
+  template<class S, class Sch>
+    requires has_transfer_member_function<S&&,Sch&&>
+  constexpr sender auto operator()(S&& s, Sch&& sch) const noexcept(noexcept(std::forward<S>(s).transfer(std::forward<Sch>(sch))))
+  {
+    return std::forward<S>(s).transfer(std::forward<Sch>(sch));
+  }
+
+  template<class S, class Sch>
+    requires (!has_transfer_member_function<S&&,Sch&&> and has_transfer_free_function<S&&,Sch&&>)
+  constexpr sender auto operator()(S&& s, Sch&& sch) const noexcept(noexcept(transfer(std::forward<S>(s), std::forward<Sch>(sch))))
+  {
+    return transfer(std::forward<S>(s), std::forward<Sch>(sch));
+  }
+
+  template<sender S, scheduler Sch>
+    requires (!has_transfer_member_function<S&&,Sch&&> and !has_transfer_free_function<S&&,Sch&&>)
+  constexpr sender auto operator()(S&& s, Sch&& sch) const
+  {
+    return transfer_sender<remove_cvref_t<S>, remove_cvref_t<Sch>>{std::forward<S>(s), std::forward<Sch>(sch)};
+  }
+};
+
+
+} // end detail
+
+
+// transfer(s, sch) sends the values sent by s from an operation scheduled on sch
+// errors and cancellation of s are forwarded without rescheduling
+constexpr detail::transfer_t transfer{};
+
+
+namespace detail
+{
+
+
+inline void spin_pause() noexcept
+{
+#if defined(__x86_64__) or defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+
+// a one-shot event on which a single thread waits
+//
+// the waiter spins briefly before sleeping in atomic::wait. the spin adapts per thread: it grows
+// while events tend to be set during the spin and shrinks while they do not
+class sync_wait_event
+{
+  public:
+    void set() noexcept
+    {
+      if(state_.exchange(set_state, std::memory_order_acq_rel) == sleeping_state)
+      {
+        state_.notify_one();
+
+        // the waiter may destroy this event as soon as it observes released_state
+        state_.store(released_state, std::memory_order_release);
+      }
+    }
+
+    void wait() noexcept
+    {
+      int& spin_count = this_thread_spin_count();
+
+      for(int i = 0; i < spin_count; ++i)
+      {
+        if(state_.load(std::memory_order_acquire) != pending_state)
+        {
+          spin_count = std::min(2 * spin_count, max_spin_count);
+          return;
+        }
+
+        spin_pause();
+      }
+
+      spin_count = std::max(spin_count / 2, min_spin_count);
+
+      int state = pending_state;
+
+      if(!state_.compare_exchange_strong(state, sleeping_state, std::memory_order_acq_rel, std::memory_order_acquire))
+      {
+        // set() did not observe a sleeper, so it is no longer touching this event
+        return;
+      }
+
+      while((state = state_.load(std::memory_order_acquire)) == sleeping_state)
+      {
+        state_.wait(sleeping_state, std::memory_order_acquire);
+      }
+
+      // set() observed a sleeper; wait for it to finish notifying
+      while(state != released_state)
+      {
+        std::this_thread::yield();
+        state = state_.load(std::memory_order_acquire);
+      }
+    }
+
+  private:
+    static constexpr int pending_state = 0;
+    static constexpr int sleeping_state = 1;
+    static constexpr int set_state = 2;
+    static constexpr int released_state = 3;
+
+    static constexpr int min_spin_count = 16;
+    static constexpr int max_spin_count = 1 << 12;
+
+    static int& this_thread_spin_count() noexcept
+    {
+      thread_local int result = 256;
+      return result;
+    }
+
+    std::atomic<int> state_{pending_state};
+};
+
+
+// the state of a sync_wait, which lives in the waiting thread's stack frame
+template<class S>
+struct sync_wait_state
+{
+  using values_type = when_all_values_t<S>;
+
+  std::optional<values_type> values_;
+#if !defined(EXECUTION_NO_EXCEPTIONS)
+  std::exception_ptr error_;
+#endif
+  sync_wait_event event_;
+};
+
+
+template<class S>
+struct sync_wait_receiver
+{
+  sync_wait_state<S>* state_;
+
+  template<class... As>
+    requires constructible_from<typename sync_wait_state<S>::values_type, As...>
+  void set_value(As&&... as) && noexcept
+  {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+    state_->values_.emplace(std::forward<As>(as)...);
+#else
+    try
+    {
+      state_->values_.emplace(std::forward<As>(as)...);
+    }
+    catch(...)
+    {
+      state_->error_ = std::current_exception();
+    }
+#endif
+
+    state_->event_.set();
+  }
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+  // without exceptions, sync_wait has no channel through which to report the error to its caller
+  template<class E>
+  [[noreturn]] void set_error(E&&) && noexcept
+  {
+    std::terminate();
+  }
+#else
+  template<class E>
+  void set_error(E&& e) && noexcept
+  {
+    if constexpr(std::is_same_v<std::exception_ptr, std::decay_t<E>>)
+    {
+      state_->error_ = std::forward<E>(e);
+    }
+    else
+    {
+      state_->error_ = std::make_exception_ptr(std::forward<E>(e));
+    }
+
+    state_->event_.set();
+  }
+#endif
+
+  void set_done() && noexcept
+  {
+    state_->event_.set();
+  }
+};
+
+
+template<class S>
+concept has_sync_wait_member_function = requires(S&& s) { std::forward<S>(s).sync_wait(); };
+
+template<class S>
+concept has_sync_wait_free_function = requires(S&& s) { sync_wait(std::forward<S>(s)); };
+
+struct sync_wait_t
+{
+  template<class S>
+    requires has_sync_wait_member_function<S&&>
+  constexpr auto operator()(S&& s) const noexcept(noexcept(std::forward<S>(s).sync_wait()))
+  {
+    return std::forward<S>(s).sync_wait();
+  }
+
+  template<class S>
+    requires (!has_sync_wait_member_function<S&&> and has_sync_wait_free_function<S&&>)
+  constexpr auto operator()(S&& s) const noexcept(noexcept(sync_wait(std::forward<S>(s))))
+  {
+    return sync_wait(std::forward<S>(s));
+  }
+
+  template<sender S>
+    requires (!has_sync_wait_member_function<S&&> and !has_sync_wait_free_function<S&&> and single_value_sender<S>)
+  std::optional<when_all_values_t<S>> operator()(S&& s) const
+  {
+    sync_wait_state<remove_cvref_t<S>> state;
+
+    auto op = execution::connect(std::forward<S>(s), sync_wait_receiver<remove_cvref_t<S>>{&state});
+    execution::start(op);
+
+    state.event_.wait();
+
+#if !defined(EXECUTION_NO_EXCEPTIONS)
+    if(state.error_)
+    {
+      std::rethrow_exception(state.error_);
+    }
+#endif
+
+    return std::move(state.values_);
+  }
+};
+
+
+} // end detail
+
+
+// sync_wait(s) blocks the calling thread until s completes and returns the values it sent
+// set_done returns an empty optional and set_error rethrows its error, or without exceptions, terminates
+// s must not complete on an execution agent which needs the calling thread to make progress
+constexpr detail::sync_wait_t sync_wait{};
+
+
+} // end execution
+
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include "execution.hpp"
+#include "intrusive_queue.hpp"
+#include <thread>
+#include <utility>
+
+
+// single_thread_context runs work on a single dedicated thread
+//
+// operation states embed a detail::task_base, so execution::start links the operation
+// into the context's lock-free queue without allocating
+class single_thread_context
+{
+  public:
+    single_thread_context()
+      : stop_task_(&single_thread_context::stop),
+        thread_([this]{ run(); })
+    {}
+
+    single_thread_context(const single_thread_context&) = delete;
+
+    // outstanding work is completed before the destructor returns
+    ~single_thread_context()
+    {
+      enqueue(&stop_task_);
+      thread_.join();
+    }
+
+    void enqueue(detail::task_base* task) const noexcept
+    {
+      if(queue_.push(task))
+      {
+        queue_.notify();
+      }
+    }
+
+    // enqueues num_tasks tasks with a single CAS and at most one wakeup
+    void enqueue(detail::intrusive_queue&& tasks, std::size_t) const noexcept
+    {
+      if(queue_.push_all(std::move(tasks)))
+      {
+        queue_.notify();
+      }
+    }
+
+    std::thread::id get_id() const noexcept
+    {
+      return thread_.get_id();
+    }
+
+
+    template<execution::receiver_of R>
+    using operation = detail::task_operation<single_thread_context, R>;
+
+
+    struct sender_type
+    {
+      template<template<class...> class Tuple, template<class...> class Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template<template<class...> class Variant>
+      using error_types = Variant<execution::error_type>;
+
+      static constexpr bool sends_done = true;
+
+      const single_thread_context& context_;
+
+      template<execution::receiver_of R>
+      operation<R> connect(R&& r) const
+      {
+        return {context_, std::forward<R>(r)};
+      }
+
+      template<class Rs>
+        requires execution::receiver_of<execution::detail::range_value_t<Rs>>
+      void submit_batch(Rs&& receivers) const
+      {
+        using submit_receiver = execution::detail::submit_receiver<const sender_type&, execution::detail::range_value_t<Rs>>;
+
+        detail::enqueue_batch(context_, receivers, [this](auto&& r)
+        {
+          return &submit_receiver::make(*this, std::move(r))->state_;
+        });
+      }
+    };
+
+
+    struct executor_type
+    {
+      const single_thread_context* context_;
+
+      template<class F>
+        requires invocable<remove_cvref_t<F>&>
+      void execute(F&& f) const
+      {
+        context_->enqueue(detail::invocable_task<remove_cvref_t<F>>::make(std::forward<F>(f)));
+      }
+
+      template<class Fs>
+        requires invocable<execution::detail::range_value_t<Fs>&>
+      void execute_batch(Fs&& fs) const
+      {
+        detail::enqueue_batch(*context_, fs, [](auto&& f)
+        {
+          return detail::invocable_task<remove_cvref_t<decltype(f)>>::make(std::move(f));
+        });
+      }
+
+      sender_type schedule() const noexcept
+      {
+        return {*context_};
+      }
+
+      friend bool operator==(const executor_type& a, const executor_type& b)
+      {
+        return a.context_ == b.context_;
+      }
+
+      friend bool operator!=(const executor_type& a, const executor_type& b)
+      {
+        return !(a == b);
+      }
+    };
+
+    executor_type executor() const
+    {
+      return {this};
+    }
+
+  private:
+    struct stop_task : detail::task_base
+    {
+      using detail::task_base::task_base;
+      bool stopped_ = false;
+    };
+
+    static void stop(detail::task_base* task) noexcept
+    {
+      static_cast<stop_task*>(task)->stopped_ = true;
+    }
+
+    void run() noexcept
+    {
+      while(!stop_task_.stopped_)
+      {
+        detail::intrusive_queue tasks = queue_.pop_all();
+
+        if(tasks.empty())
+        {
+          queue_.wait();
+          continue;
+        }
+
+        execute_all(tasks);
+      }
+
+      // drain work enqueued by the tasks which ran alongside stop_task_
+      for(detail::intrusive_queue tasks = queue_.pop_all(); !tasks.empty(); tasks = queue_.pop_all())
+      {
+        execute_all(tasks);
+      }
+    }
+
+    static void execute_all(detail::intrusive_queue& tasks) noexcept
+    {
+      while(detail::task_base* task = tasks.pop_front())
+      {
+        task->execute();
+      }
+    }
+
+    mutable detail::atomic_intrusive_queue queue_;
+    stop_task stop_task_;
+    std::thread thread_;
+};
+
+
+static_assert(execution::executor<single_thread_context::executor_type>);
+static_assert(execution::scheduler<single_thread_context::executor_type>);
+
@@ -0,0 +1,407 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include "execution.hpp"
+#include <functional>
+#include "intrusive_queue.hpp"
+#include <memory>
+#include <semaphore>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace detail
+{
+
+
+// a bounded multiple-producer multiple-consumer queue of task_base*
+//
+// each cell carries a sequence number which tells producers and consumers whether it is theirs
+// to claim, so that pushing and popping each cost a single CAS on their own position, and the
+// queue's storage is allocated once, at construction
+//
+// see Vyukov, "Bounded MPMC queue", 1024cores.net
+class bounded_mpmc_queue
+{
+  public:
+    struct cell
+    {
+      std::atomic<std::size_t> sequence_;
+      task_base* task_;
+    };
+
+    // capacity is rounded up to a power of two
+    explicit bounded_mpmc_queue(std::size_t capacity)
+      : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+        cells_(new cell[mask_ + 1]),
+        enqueue_position_(0),
+        dequeue_position_(0)
+    {
+      for(std::size_t i = 0; i <= mask_; ++i)
+      {
+        cells_[i].sequence_.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    std::size_t capacity() const noexcept
+    {
+      return mask_ + 1;
+    }
+
+    // claims the next cell for a task, or returns nullptr if the queue is full
+    // the cell must then be passed to commit, and consumers which reach it wait until it is
+    cell* reserve() noexcept
+    {
+      std::size_t position = enqueue_position_.load(std::memory_order_relaxed);
+
+      while(true)
+      {
+        cell& c = cells_[position & mask_];
+        std::size_t sequence = c.sequence_.load(std::memory_order_acquire);
+        std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+        if(difference == 0)
+        {
+          if(enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          {
+            return &c;
+          }
+        }
+        else if(difference < 0)
+        {
+          return nullptr;
+        }
+        else
+        {
+          position = enqueue_position_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    // publishes task in a cell claimed by reserve
+    static void commit(cell* c, task_base* task) noexcept
+    {
+      c->task_ = task;
+
+      // a claimed cell's sequence remains the position it was claimed at until it is committed
+      c->sequence_.store(c->sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // returns nullptr if the queue is empty, or if the next task has been reserved but not yet committed
+    task_base* try_pop() noexcept
+    {
+      std::size_t position = dequeue_position_.load(std::memory_order_relaxed);
+
+      while(true)
+      {
+        cell& c = cells_[position & mask_];
+        std::size_t sequence = c.sequence_.load(std::memory_order_acquire);
+        std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+        if(difference == 0)
+        {
+          if(dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          {
+            task_base* result = c.task_;
+            c.sequence_.store(position + mask_ + 1, std::memory_order_release);
+            return result;
+          }
+        }
+        else if(difference < 0)
+        {
+          return nullptr;
+        }
+        else
+        {
+          position = dequeue_position_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    // unlike try_pop, waits for the next task to be committed once it has been reserved
+    // returns nullptr only if every task reserved has been popped
+    task_base* pop() noexcept
+    {
+      while(true)
+      {
+        if(task_base* result = try_pop())
+        {
+          return result;
+        }
+
+        if(enqueue_position_.load(std::memory_order_acquire) == dequeue_position_.load(std::memory_order_relaxed))
+        {
+          return nullptr;
+        }
+
+        std::this_thread::yield();
+      }
+    }
+
+  private:
+    const std::size_t mask_;
+    const std::unique_ptr<cell[]> cells_;
+
+    // producers and consumers each contend on their own cache line
+    alignas(64) std::atomic<std::size_t> enqueue_position_;
+    alignas(64) std::atomic<std::size_t> dequeue_position_;
+};
+
+
+// the error reported for work which arrives while a static_thread_pool's queue is full
+inline std::system_error queue_full_error()
+{
+  return std::system_error(std::make_error_code(std::errc::resource_unavailable_try_again), "static_thread_pool: queue is full");
+}
+
+
+} // end detail
+
+
+// static_thread_pool runs work on a fixed number of threads which share a single bounded queue
+//
+// the queue's capacity is fixed at construction, so that a burst of work cannot grow the pool's
+// memory. what becomes of work which arrives while the queue is full is the pool's overflow_policy:
+//   * reject: starting an operation upon the pool completes its receiver with set_error, and execute
+//     throws std::system_error before taking ownership of its invocable, which connect and submit in
+//     turn deliver through set_error. without exceptions, execute instead destroys the invocable
+//     without invoking it, which completes the receiver of a connected or submitted executor with set_done
+//   * caller_runs: the work runs immediately upon the thread which submitted it, which slows producers
+//     down to the rate the pool drains its queue
+//
+// rejections report std::errc::resource_unavailable_try_again
+class static_thread_pool
+{
+  public:
+    enum class overflow_policy
+    {
+      reject,
+      caller_runs
+    };
+
+    explicit static_thread_pool(std::size_t num_threads = std::thread::hardware_concurrency(),
+                                std::size_t capacity = 1024,
+                                overflow_policy policy = overflow_policy::reject)
+      : policy_(policy),
+        queue_(capacity),
+        ready_(0),
+        skipped_task_(&static_thread_pool::skip)
+    {
+      num_threads = num_threads ? num_threads : 1;
+
+      for(std::size_t i = 0; i < num_threads; ++i)
+      {
+        threads_.emplace_back([this]{ run(); });
+      }
+    }
+
+    static_thread_pool(const static_thread_pool&) = delete;
+
+    // outstanding work is completed before the destructor returns
+    ~static_thread_pool()
+    {
+      // a worker which finds the queue empty after a release which no task accompanies exits
+      ready_.release(static_cast<std::ptrdiff_t>(threads_.size()));
+
+      for(std::thread& t : threads_)
+      {
+        t.join();
+      }
+    }
+
+    std::size_t num_threads() const noexcept
+    {
+      return threads_.size();
+    }
+
+    std::size_t capacity() const noexcept
+    {
+      return queue_.capacity();
+    }
+
+    overflow_policy policy() const noexcept
+    {
+      return policy_;
+    }
+
+    // returns false, without enqueueing task, if the queue is full
+    bool try_enqueue(detail::task_base* task) const noexcept
+    {
+      detail::bounded_mpmc_queue::cell* cell = queue_.reserve();
+
+      if(!cell)
+      {
+        return false;
+      }
+
+      commit(cell, task);
+      return true;
+    }
+
+
+    template<execution::receiver_of R>
+    struct operation : detail::task_operation<static_thread_pool, R>
+    {
+      template<class OtherR>
+      operation(const static_thread_pool& pool, OtherR&& r)
+        : detail::task_operation<static_thread_pool, R>(pool, std::forward<OtherR>(r))
+      {}
+
+      void start() noexcept
+      {
+        if(this->context_.try_enqueue(this))
+        {
+          return;
+        }
+
+        if(this->context_.policy_ == overflow_policy::caller_runs)
+        {
+          detail::task_operation<static_thread_pool, R>::execute(this);
+        }
+        else
+        {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+          execution::set_error(std::move(this->receiver_), detail::queue_full_error().code());
+#else
+          execution::set_error(std::move(this->receiver_), std::make_exception_ptr(detail::queue_full_error()));
+#endif
+        }
+      }
+    };
+
+
+    struct sender_type
+    {
+      template<template<class...> class Tuple, template<class...> class Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template<template<class...> class Variant>
+      using error_types = Variant<execution::error_type>;
+
+      static constexpr bool sends_done = true;
+
+      const static_thread_pool& pool_;
+
+      template<execution::receiver_of R>
+      operation<R> connect(R&& r) const
+      {
+        return {pool_, std::forward<R>(r)};
+      }
+    };
+
+
+    struct executor_type
+    {
+      const static_thread_pool* pool_;
+
+      template<class F>
+        requires invocable<remove_cvref_t<F>&>
+      void execute(F&& f) const
+      {
+        using task_type = detail::invocable_task<remove_cvref_t<F>>;
+
+        // a cell is reserved before f is moved from, so that f is still whole if the queue is full
+        detail::bounded_mpmc_queue::cell* cell = pool_->queue_.reserve();
+
+        if(!cell)
+        {
+          pool_->overflow(f);
+          return;
+        }
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+        pool_->commit(cell, task_type::make(std::forward<F>(f)));
+#else
+        try
+        {
+          pool_->commit(cell, task_type::make(std::forward<F>(f)));
+        }
+        catch(...)
+        {
+          // consumers wait for every reserved cell to be committed
+          pool_->commit(cell, &pool_->skipped_task_);
+          throw;
+        }
+#endif
+      }
+
+      sender_type schedule() const noexcept
+      {
+        return {*pool_};
+      }
+
+      friend bool operator==(const executor_type& a, const executor_type& b)
+      {
+        return a.pool_ == b.pool_;
+      }
+
+      friend bool operator!=(const executor_type& a, const executor_type& b)
+      {
+        return !(a == b);
+      }
+    };
+
+    executor_type executor() const
+    {
+      return {this};
+    }
+
+  private:
+    static void skip(detail::task_base*) noexcept {}
+
+    void commit(detail::bounded_mpmc_queue::cell* cell, detail::task_base* task) const noexcept
+    {
+      detail::bounded_mpmc_queue::commit(cell, task);
+      ready_.release();
+    }
+
+    // disposes of f, which arrived while the queue was full
+    template<class F>
+    void overflow(F& f) const
+    {
+      if(policy_ == overflow_policy::caller_runs)
+      {
+        std::invoke(f);
+        return;
+      }
+
+#if !defined(EXECUTION_NO_EXCEPTIONS)
+      throw detail::queue_full_error();
+#endif
+    }
+
+    void run() noexcept
+    {
+      while(true)
+      {
+        ready_.acquire();
+
+        // each release is preceded by a commit, except the destructor's
+        detail::task_base* task = queue_.pop();
+
+        if(!task)
+        {
+          return;
+        }
+
+        task->execute();
+      }
+    }
+
+    const overflow_policy policy_;
+    mutable detail::bounded_mpmc_queue queue_;
+    mutable std::counting_semaphore<> ready_;
+    mutable detail::task_base skipped_task_;
+    std::vector<std::thread> threads_;
+};
+
+
+static_assert(execution::executor<static_thread_pool::executor_type>);
+static_assert(execution::scheduler<static_thread_pool::executor_type>);
@@ -0,0 +1,352 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <utility>
+
+
+namespace execution
+{
+
+
+// never_stop_token is the stop token of receivers which do not support cancellation
+// its operations are constant expressions, so polling it costs nothing
+class never_stop_token
+{
+  public:
+    template<class F>
+    struct callback_type
+    {
+      explicit callback_type(never_stop_token, F&&) noexcept {}
+    };
+
+    static constexpr bool stop_requested() noexcept
+    {
+      return false;
+    }
+
+    static constexpr bool stop_possible() noexcept
+    {
+      return false;
+    }
+
+    friend constexpr bool operator==(never_stop_token, never_stop_token) noexcept
+    {
+      return true;
+    }
+
+    friend constexpr bool operator!=(never_stop_token, never_stop_token) noexcept
+    {
+      return false;
+    }
+};
+
+
+class in_place_stop_source;
+class in_place_stop_token;
+
+template<class F>
+class in_place_stop_callback;
+
+
+namespace detail
+{
+
+
+// the intrusive hook embedded in each in_place_stop_callback
+struct in_place_stop_callback_base
+{
+  void (*execute_)(in_place_stop_callback_base*) noexcept;
+  in_place_stop_source* source_ = nullptr;
+  in_place_stop_callback_base* next_ = nullptr;
+  in_place_stop_callback_base** prev_ptr_ = nullptr;
+  bool* removed_during_callback_ = nullptr;
+  std::atomic<bool> callback_completed_{false};
+
+  explicit in_place_stop_callback_base(void (*execute)(in_place_stop_callback_base*) noexcept) noexcept
+    : execute_(execute)
+  {}
+};
+
+
+} // end detail
+
+
+// in_place_stop_source is a stop source which never allocates
+//
+// callbacks are linked intrusively into the source, which must outlive every token
+// and callback obtained from it
+class in_place_stop_source
+{
+  public:
+    in_place_stop_source() = default;
+
+    in_place_stop_source(const in_place_stop_source&) = delete;
+
+    in_place_stop_token get_token() const noexcept;
+
+    bool stop_requested() const noexcept
+    {
+      return state_.load(std::memory_order_acquire) & stop_requested_flag;
+    }
+
+    // invokes every registered callback on the calling thread
+    // returns false if stop had already been requested
+    bool request_stop() noexcept
+    {
+      if(!lock_unless_stop_requested(true))
+      {
+        return false;
+      }
+
+      notifying_thread_ = std::this_thread::get_id();
+
+      while(callbacks_)
+      {
+        detail::in_place_stop_callback_base* callback = callbacks_;
+        callback->prev_ptr_ = nullptr;
+        callbacks_ = callback->next_;
+
+        if(callbacks_)
+        {
+          callbacks_->prev_ptr_ = &callbacks_;
+        }
+
+        unlock(stop_requested_flag);
+
+        bool removed_during_callback = false;
+        callback->removed_during_callback_ = &removed_during_callback;
+
+        callback->execute_(callback);
+
+        // the callback may have destroyed itself
+        if(!removed_during_callback)
+        {
+          callback->removed_during_callback_ = nullptr;
+          callback->callback_completed_.store(true, std::memory_order_release);
+        }
+
+        lock();
+      }
+
+      unlock(stop_requested_flag);
+      return true;
+    }
+
+  private:
+    template<class F>
+    friend class in_place_stop_callback;
+
+    static constexpr std::uint8_t stop_requested_flag = 1;
+    static constexpr std::uint8_t locked_flag = 2;
+
+    std::uint8_t lock() noexcept
+    {
+      std::uint8_t old_state = state_.load(std::memory_order_relaxed);
+
+      while(true)
+      {
+        if(old_state & locked_flag)
+        {
+          std::this_thread::yield();
+          old_state = state_.load(std::memory_order_relaxed);
+        }
+        else if(state_.compare_exchange_weak(old_state, old_state | locked_flag, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+          return old_state;
+        }
+      }
+    }
+
+    // returns false without locking if stop has been requested
+    bool lock_unless_stop_requested(bool request_stop) noexcept
+    {
+      std::uint8_t old_state = state_.load(std::memory_order_relaxed);
+
+      while(true)
+      {
+        if(old_state & stop_requested_flag)
+        {
+          return false;
+        }
+        else if(old_state & locked_flag)
+        {
+          std::this_thread::yield();
+          old_state = state_.load(std::memory_order_relaxed);
+        }
+        else
+        {
+          std::uint8_t new_state = locked_flag | (request_stop ? stop_requested_flag : 0);
+
+          if(state_.compare_exchange_weak(old_state, new_state, std::memory_order_acq_rel, std::memory_order_relaxed))
+          {
+            return true;
+          }
+        }
+      }
+    }
+
+    void unlock(std::uint8_t new_state) noexcept
+    {
+      state_.store(new_state, std::memory_order_release);
+    }
+
+    // returns false if stop has been requested, in which case callback was not added
+    bool try_add(detail::in_place_stop_callback_base* callback) noexcept
+    {
+      if(!lock_unless_stop_requested(false))
+      {
+        return false;
+      }
+
+      callback->next_ = callbacks_;
+      callback->prev_ptr_ = &callbacks_;
+
+      if(callbacks_)
+      {
+        callbacks_->prev_ptr_ = &callback->next_;
+      }
+
+      callbacks_ = callback;
+
+      unlock(0);
+      return true;
+    }
+
+    void remove(detail::in_place_stop_callback_base* callback) noexcept
+    {
+      std::uint8_t old_state = lock();
+
+      if(callback->prev_ptr_)
+      {
+        // the callback has not been invoked
+        *callback->prev_ptr_ = callback->next_;
+
+        if(callback->next_)
+        {
+          callback->next_->prev_ptr_ = callback->prev_ptr_;
+        }
+
+        unlock(old_state);
+        return;
+      }
+
+      std::thread::id notifying_thread = notifying_thread_;
+      unlock(old_state);
+
+      if(notifying_thread == std::this_thread::get_id())
+      {
+        // the callback is removing itself from within its invocation
+        if(callback->removed_during_callback_)
+        {
+          *callback->removed_during_callback_ = true;
+        }
+      }
+      else
+      {
+        // wait for the invocation on the notifying thread to complete
+        while(!callback->callback_completed_.load(std::memory_order_acquire))
+        {
+          std::this_thread::yield();
+        }
+      }
+    }
+
+    std::atomic<std::uint8_t> state_{0};
+    detail::in_place_stop_callback_base* callbacks_ = nullptr;
+    std::thread::id notifying_thread_;
+};
+
+
+class in_place_stop_token
+{
+  public:
+    template<class F>
+    using callback_type = in_place_stop_callback<F>;
+
+    in_place_stop_token() noexcept = default;
+
+    bool stop_requested() const noexcept
+    {
+      return source_ and source_->stop_requested();
+    }
+
+    bool stop_possible() const noexcept
+    {
+      return source_ != nullptr;
+    }
+
+    friend bool operator==(const in_place_stop_token& a, const in_place_stop_token& b) noexcept
+    {
+      return a.source_ == b.source_;
+    }
+
+    friend bool operator!=(const in_place_stop_token& a, const in_place_stop_token& b) noexcept
+    {
+      return !(a == b);
+    }
+
+  private:
+    friend class in_place_stop_source;
+
+    template<class F>
+    friend class in_place_stop_callback;
+
+    explicit in_place_stop_token(in_place_stop_source* source) noexcept
+      : source_(source)
+    {}
+
+    in_place_stop_source* source_ = nullptr;
+};
+
+
+inline in_place_stop_token in_place_stop_source::get_token() const noexcept
+{
+  return in_place_stop_token{const_cast<in_place_stop_source*>(this)};
+}
+
+
+// in_place_stop_callback invokes f when stop is requested on the token's source
+// if stop has already been requested, f is invoked immediately by the constructor
+template<class F>
+class in_place_stop_callback : private detail::in_place_stop_callback_base
+{
+  public:
+    template<class G>
+    explicit in_place_stop_callback(in_place_stop_token token, G&& g)
+      : detail::in_place_stop_callback_base(&in_place_stop_callback::execute),
+        f_(std::forward<G>(g))
+    {
+      source_ = token.source_;
+
+      if(source_ and !source_->try_add(this))
+      {
+        source_ = nullptr;
+        std::invoke(f_);
+      }
+    }
+
+    in_place_stop_callback(const in_place_stop_callback&) = delete;
+
+    ~in_place_stop_callback()
+    {
+      if(source_)
+      {
+        source_->remove(this);
+      }
+    }
+
+  private:
+    static void execute(detail::in_place_stop_callback_base* self) noexcept
+    {
+      std::invoke(static_cast<in_place_stop_callback*>(self)->f_);
+    }
+
+    F f_;
+};
+
+
+} // end execution
+
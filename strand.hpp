@@ -0,0 +1,236 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include "execution.hpp"
+#include "execution_context.hpp"
+#include "intrusive_queue.hpp"
+#include <memory>
+#include <thread>
+#include <utility>
+
+
+namespace detail
+{
+
+
+// the state shared by the copies of a strand
+//
+// size_ counts the tasks which have been, or are about to be, pushed onto queue_ and have yet to run.
+// the producer which raises it from zero posts a drain, so that exactly one drain is in flight while
+// it is nonzero. producers increment size_ before they push, so a drain which finds queue_ empty while
+// size_ is nonzero knows that a task is about to arrive, and waits for it. the strand is therefore not
+// lock-free: a producer preempted between the two blocks the drain until it resumes
+template<class Executor>
+class strand_state : public std::enable_shared_from_this<strand_state<Executor>>
+{
+  public:
+    strand_state(const Executor& ex, std::size_t batch_limit)
+      : ex_(ex),
+        batch_limit_(batch_limit),
+        size_(0)
+    {}
+
+    const Executor& executor() const noexcept
+    {
+      return ex_;
+    }
+
+    std::size_t batch_limit() const noexcept
+    {
+      return batch_limit_;
+    }
+
+    void enqueue(task_base* task) const noexcept
+    {
+      bool first = size_.fetch_add(1, std::memory_order_acq_rel) == 0;
+
+      queue_.push(task);
+
+      if(first and !try_post())
+      {
+        run();
+      }
+    }
+
+  private:
+    // returns false if ex_ could not accept the drain, which the caller must then run itself
+    // so that the tasks already counted by size_ are not stranded
+    bool try_post() const noexcept
+    {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+      execution::execute(ex_, [self = this->shared_from_this()]{ self->run(); });
+      return true;
+#else
+      try
+      {
+        execution::execute(ex_, [self = this->shared_from_this()]{ self->run(); });
+        return true;
+      }
+      catch(...)
+      {
+        return false;
+      }
+#endif
+    }
+
+    void run() const noexcept
+    {
+      while(drain_batch())
+      {
+        // tasks remain, so yield to the executor's other work by posting the next batch behind it.
+        // an inline executor would only run the next batch beneath this one, so it is run here instead
+        if constexpr(!execution::is_inline_executor_v<Executor>)
+        {
+          if(try_post())
+          {
+            return;
+          }
+        }
+      }
+    }
+
+    // runs at most batch_limit_ tasks and returns whether any remain
+    bool drain_batch() const noexcept
+    {
+      std::size_t num_run = 0;
+
+      while(num_run < batch_limit_)
+      {
+        task_base* task = pending_.pop_front();
+
+        if(!task)
+        {
+          pending_ = queue_.pop_all();
+          task = pending_.pop_front();
+        }
+
+        if(!task)
+        {
+          if(num_run > 0)
+          {
+            break;
+          }
+
+          // size_ counts a task whose producer has yet to push it. yielding lets a preempted
+          // producer run, but the drain cannot proceed until it does
+          std::this_thread::yield();
+          continue;
+        }
+
+        task->execute();
+        ++num_run;
+      }
+
+      return size_.fetch_sub(num_run, std::memory_order_acq_rel) != num_run;
+    }
+
+    Executor ex_;
+    const std::size_t batch_limit_;
+    mutable std::atomic<std::size_t> size_;
+    mutable atomic_intrusive_queue queue_;
+
+    // the tasks popped from queue_ which the drain has yet to run. only the drain in flight touches
+    // pending_, and each drain happens after the last through either the post or size_
+    mutable intrusive_queue pending_;
+};
+
+
+} // end detail
+
+
+// strand serializes the work it is given upon Executor: tasks run one at a time, in the order
+// they were submitted, though not necessarily upon the same thread
+//
+// submission takes no locks: tasks are pushed onto an atomic intrusive queue, which a single drain
+// posted to Executor at a time empties. the drain may wait for a producer which was preempted between
+// counting its task and pushing it. a drain runs at most batch_limit tasks before posting itself
+// again, so that the strand's work takes turns with other work sharing Executor rather than
+// monopolizing one of its threads. copies of a strand share its queue
+template<class Executor>
+class strand
+{
+  private:
+    using state_type = detail::strand_state<Executor>;
+
+  public:
+    static constexpr std::size_t default_batch_limit = 64;
+
+    explicit strand(const Executor& ex, std::size_t batch_limit = default_batch_limit)
+      : state_(std::make_shared<state_type>(ex, batch_limit ? batch_limit : 1))
+    {}
+
+    const Executor& base() const noexcept
+    {
+      return state_->executor();
+    }
+
+    std::size_t batch_limit() const noexcept
+    {
+      return state_->batch_limit();
+    }
+
+    template<class F>
+      requires invocable<remove_cvref_t<F>&>
+    void execute(F&& f) const
+    {
+      state_->enqueue(detail::invocable_task<remove_cvref_t<F>>::make(std::forward<F>(f)));
+    }
+
+
+    // a task_operation which keeps the strand's state alive until it is destroyed
+    template<execution::receiver_of R>
+    struct operation : detail::task_operation<state_type, R>
+    {
+      std::shared_ptr<const state_type> state_;
+
+      template<class OtherR>
+      operation(std::shared_ptr<const state_type> state, OtherR&& r)
+        : detail::task_operation<state_type, R>(*state, std::forward<OtherR>(r)),
+          state_(std::move(state))
+      {}
+    };
+
+
+    struct sender_type
+    {
+      template<template<class...> class Tuple, template<class...> class Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template<template<class...> class Variant>
+      using error_types = Variant<execution::error_type>;
+
+      static constexpr bool sends_done = true;
+
+      std::shared_ptr<const state_type> state_;
+
+      template<execution::receiver_of R>
+      operation<R> connect(R&& r) const
+      {
+        return {state_, std::forward<R>(r)};
+      }
+    };
+
+
+    sender_type schedule() const noexcept
+    {
+      return {state_};
+    }
+
+    friend bool operator==(const strand& a, const strand& b)
+    {
+      return a.state_ == b.state_;
+    }
+
+    friend bool operator!=(const strand& a, const strand& b)
+    {
+      return !(a == b);
+    }
+
+  private:
+    std::shared_ptr<const state_type> state_;
+};
+
+
+static_assert(execution::executor<strand<execution_context::executor_type>>);
+static_assert(execution::scheduler<strand<execution_context::executor_type>>);
@@ -0,0 +1,563 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include "execution.hpp"
+#include "pool_allocator.hpp"
+#include "sender_algorithms.hpp"
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+
+namespace execution
+{
+
+
+template<class T = void>
+class task;
+
+
+namespace detail
+{
+
+
+template<class List>
+struct await_result_of_type_list
+{
+  using type = type_list_apply_t<std::tuple, List>;
+};
+
+template<>
+struct await_result_of_type_list<type_list<>>
+{
+  using type = void;
+};
+
+template<class T>
+struct await_result_of_type_list<type_list<T>>
+{
+  using type = T;
+};
+
+// the result of co_await s: void, the single value s sends, or a std::tuple of its values
+template<class S>
+using sender_await_result_t = typename await_result_of_type_list<
+  type_list_apply_t<type_list_concat_t, decayed_value_type_lists_t<S>>
+>::type;
+
+
+// where a coroutine keeps the result of an awaited operation; void results are stored as std::monostate
+template<class T>
+using await_result_storage_t = std::variant<
+  std::monostate,
+  std::conditional_t<std::is_void_v<T>, std::monostate, T>,
+  error_type
+>;
+
+
+template<class T>
+T take_await_result(await_result_storage_t<T>& result)
+{
+#if !defined(EXECUTION_NO_EXCEPTIONS)
+  // without exceptions, an error stops the coroutine rather than resuming it
+  if(result.index() == 2)
+  {
+    std::rethrow_exception(std::get<2>(std::move(result)));
+  }
+#endif
+
+  if constexpr(!std::is_void_v<T>)
+  {
+    return std::get<1>(std::move(result));
+  }
+}
+
+
+// the part of task<T>'s promise which does not depend on T
+class task_promise_base
+{
+  public:
+    // coroutine frames are drawn from the pool which backs pool_allocator
+    static void* operator new(std::size_t n)
+    {
+      return thread_caching_pool::allocate(n);
+    }
+
+    static void operator delete(void* p, std::size_t n) noexcept
+    {
+      thread_caching_pool::deallocate(p, n);
+    }
+
+    std::suspend_always initial_suspend() noexcept
+    {
+      return {};
+    }
+
+    struct final_awaiter
+    {
+      bool await_ready() noexcept
+      {
+        return false;
+      }
+
+      template<class Promise>
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept
+      {
+        task_promise_base& self = h.promise();
+
+        if(self.continuation_)
+        {
+          return self.continuation_;
+        }
+
+        // the receiver may destroy this coroutine, so nothing may touch it afterward
+        self.complete_(self.operation_);
+        return std::noop_coroutine();
+      }
+
+      void await_resume() noexcept {}
+    };
+
+    final_awaiter final_suspend() noexcept
+    {
+      return {};
+    }
+
+    // called when an awaited sender completes with set_done
+    // returns the coroutine to resume next, having stopped this task and all tasks awaiting it
+    std::coroutine_handle<> unhandled_done() noexcept
+    {
+      if(parent_)
+      {
+        return parent_->unhandled_done();
+      }
+
+      done_(operation_);
+      return std::noop_coroutine();
+    }
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+    // called when an awaited sender completes with set_error, which cannot be thrown into the coroutine
+    // like unhandled_done, stops this task and all tasks awaiting it, and delivers e to the receiver
+    std::coroutine_handle<> unhandled_error(error_type e) noexcept
+    {
+      if(parent_)
+      {
+        return parent_->unhandled_error(std::move(e));
+      }
+
+      error_(operation_, std::move(e));
+      return std::noop_coroutine();
+    }
+#endif
+
+  protected:
+    template<class>
+    friend class execution::task;
+
+    // set when this task is awaited by another task
+    std::coroutine_handle<> continuation_;
+    task_promise_base* parent_ = nullptr;
+
+    // set when this task is connected to a receiver
+    void* operation_ = nullptr;
+    void (*complete_)(void*) noexcept = nullptr;
+    void (*done_)(void*) noexcept = nullptr;
+#if defined(EXECUTION_NO_EXCEPTIONS)
+    void (*error_)(void*, error_type) noexcept = nullptr;
+#endif
+};
+
+
+// awaits a sender from within a task
+// the sender's operation state lives in this awaiter, which lives in the awaiting coroutine's frame
+template<class S, class Promise>
+class sender_awaiter
+{
+  private:
+    using result_type = sender_await_result_t<S>;
+
+    struct receiver
+    {
+      sender_awaiter* awaiter_;
+
+      template<class... As>
+        requires (std::is_void_v<result_type> ? sizeof...(As) == 0 : constructible_from<std::conditional_t<std::is_void_v<result_type>, int, result_type>, As...>)
+      void set_value(As&&... as) && noexcept
+      {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+        awaiter_->result_.template emplace<1>(std::forward<As>(as)...);
+#else
+        try
+        {
+          awaiter_->result_.template emplace<1>(std::forward<As>(as)...);
+        }
+        catch(...)
+        {
+          awaiter_->result_.template emplace<2>(std::current_exception());
+        }
+#endif
+
+        awaiter_->complete();
+      }
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+      template<class E>
+        requires constructible_from<error_type, E>
+      void set_error(E&& e) && noexcept
+      {
+        awaiter_->result_.template emplace<2>(std::forward<E>(e));
+        awaiter_->complete();
+      }
+#else
+      template<class E>
+      void set_error(E&& e) && noexcept
+      {
+        if constexpr(std::is_same_v<std::exception_ptr, std::decay_t<E>>)
+        {
+          awaiter_->result_.template emplace<2>(std::forward<E>(e));
+        }
+        else
+        {
+          awaiter_->result_.template emplace<2>(std::make_exception_ptr(std::forward<E>(e)));
+        }
+
+        awaiter_->complete();
+      }
+#endif
+
+      void set_done() && noexcept
+      {
+        awaiter_->done_ = true;
+        awaiter_->complete();
+      }
+    };
+
+    // whether the sender's completion stops the coroutine rather than resuming it
+    bool stops_coroutine() const noexcept
+    {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+      return done_ or result_.index() == 2;
+#else
+      return done_;
+#endif
+    }
+
+    std::coroutine_handle<> next() noexcept
+    {
+      if(!stops_coroutine())
+      {
+        return continuation_;
+      }
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+      if(!done_)
+      {
+        return continuation_.promise().unhandled_error(std::get<2>(std::move(result_)));
+      }
+#endif
+
+      return continuation_.promise().unhandled_done();
+    }
+
+    // the first of start's return and the sender's completion to arrive lets the other resume the coroutine,
+    // so a sender completing inline resumes it without growing the stack
+    void complete() noexcept
+    {
+      if(ready_.exchange(true, std::memory_order_acq_rel))
+      {
+        next().resume();
+      }
+    }
+
+    std::coroutine_handle<Promise> continuation_;
+    await_result_storage_t<result_type> result_;
+    bool done_ = false;
+    std::atomic<bool> ready_{false};
+    connect_result_t<S, receiver> op_;
+
+  public:
+    template<class OtherS>
+    sender_awaiter(OtherS&& s, std::coroutine_handle<Promise> continuation)
+      : continuation_(continuation),
+        op_(execution::connect(std::forward<OtherS>(s), receiver{this}))
+    {}
+
+    // the operation state's receiver refers to this object, so it must not move
+    sender_awaiter(sender_awaiter&&) = delete;
+
+    bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<Promise>) noexcept
+    {
+      execution::start(op_);
+
+      if(ready_.exchange(true, std::memory_order_acq_rel))
+      {
+        // the sender completed inline
+        if(!stops_coroutine())
+        {
+          return false;
+        }
+
+        next().resume();
+      }
+
+      return true;
+    }
+
+    result_type await_resume()
+    {
+      return detail::take_await_result<result_type>(result_);
+    }
+};
+
+
+template<class T>
+class task_promise_return
+{
+  public:
+    template<class U>
+      requires convertible_to<U, T>
+    void return_value(U&& value)
+    {
+      result_.template emplace<1>(std::forward<U>(value));
+    }
+
+  protected:
+    await_result_storage_t<T> result_;
+};
+
+template<>
+class task_promise_return<void>
+{
+  public:
+    void return_void() noexcept
+    {
+      result_.emplace<1>();
+    }
+
+  protected:
+    await_result_storage_t<void> result_;
+};
+
+
+} // end detail
+
+
+// task<T> is a lazily-started coroutine which is also a sender of T
+//
+// within a task, co_await accepts any sender which sends a single set of values. the sender's
+// operation state is kept in the coroutine frame, so co_await execution::schedule(ex) moves the
+// coroutine onto ex without allocating. an awaited sender completing with set_done stops the task,
+// and every task awaiting it, with set_done. set_error is thrown from co_await, or without exceptions,
+// stops the tasks as set_done does and completes the outermost with set_error
+template<class T>
+class task
+{
+  public:
+    class promise_type : public detail::task_promise_base, public detail::task_promise_return<T>
+    {
+      public:
+        task get_return_object() noexcept
+        {
+          return task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        void unhandled_exception() noexcept
+        {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+          // the coroutine threw, but without exceptions there is no error_type to report it as
+          std::terminate();
+#else
+          this->result_.template emplace<2>(std::current_exception());
+#endif
+        }
+
+        template<class U>
+        auto await_transform(task<U>&& t) noexcept
+        {
+          return typename task<U>::awaiter{std::exchange(t.handle_, {})};
+        }
+
+        template<sender S>
+          requires detail::single_value_sender<S>
+        detail::sender_awaiter<S, promise_type> await_transform(S&& s)
+        {
+          return {std::forward<S>(s), std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        template<class A>
+          requires (!sender<A>)
+        A&& await_transform(A&& a) noexcept
+        {
+          return std::forward<A>(a);
+        }
+
+      private:
+        friend class task;
+    };
+
+    template<template<class...> class Tuple, template<class...> class Variant>
+    using value_types = std::conditional_t<std::is_void_v<T>, Variant<Tuple<>>, Variant<Tuple<std::conditional_t<std::is_void_v<T>, int, T>>>>;
+
+    template<template<class...> class Variant>
+    using error_types = Variant<error_type>;
+
+    static constexpr bool sends_done = true;
+
+    task(task&& other) noexcept
+      : handle_(std::exchange(other.handle_, {}))
+    {}
+
+    ~task()
+    {
+      if(handle_)
+      {
+        handle_.destroy();
+      }
+    }
+
+
+    template<receiver_of R>
+    class operation
+    {
+      public:
+        operation(std::coroutine_handle<promise_type> handle, R&& r)
+          : handle_(handle),
+            receiver_(std::move(r))
+        {}
+
+        // the coroutine refers to this object, so it must not move
+        operation(operation&&) = delete;
+
+        ~operation()
+        {
+          handle_.destroy();
+        }
+
+        void start() noexcept
+        {
+          promise_type& promise = handle_.promise();
+          promise.operation_ = this;
+          promise.complete_ = &operation::complete;
+          promise.done_ = &operation::done;
+#if defined(EXECUTION_NO_EXCEPTIONS)
+          promise.error_ = &operation::error;
+#endif
+
+          handle_.resume();
+        }
+
+      private:
+        static void complete(void* op) noexcept
+        {
+          operation& self = *static_cast<operation*>(op);
+          auto& result = self.handle_.promise().result_;
+
+          if(result.index() == 2)
+          {
+            execution::set_error(std::move(self.receiver_), std::get<2>(std::move(result)));
+            return;
+          }
+
+          if constexpr(std::is_void_v<T>)
+          {
+            detail::set_value_or_error(std::move(self.receiver_));
+          }
+          else
+          {
+            detail::set_value_or_error(std::move(self.receiver_), std::get<1>(std::move(result)));
+          }
+        }
+
+        static void done(void* op) noexcept
+        {
+          operation& self = *static_cast<operation*>(op);
+          execution::set_done(std::move(self.receiver_));
+        }
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+        static void error(void* op, error_type e) noexcept
+        {
+          operation& self = *static_cast<operation*>(op);
+          execution::set_error(std::move(self.receiver_), std::move(e));
+        }
+#endif
+
+        std::coroutine_handle<promise_type> handle_;
+        R receiver_;
+    };
+
+    template<receiver R>
+    operation<remove_cvref_t<R>> connect(R&& r) &&
+    {
+      return {std::exchange(handle_, {}), remove_cvref_t<R>(std::forward<R>(r))};
+    }
+
+  private:
+    template<class>
+    friend class task;
+
+    // awaits a task from within another task, transferring control between the coroutines
+    // symmetrically so that chains of tasks do not grow the stack
+    class awaiter
+    {
+      public:
+        explicit awaiter(std::coroutine_handle<promise_type> handle) noexcept
+          : handle_(handle)
+        {}
+
+        awaiter(awaiter&& other) noexcept
+          : handle_(std::exchange(other.handle_, {}))
+        {}
+
+        ~awaiter()
+        {
+          if(handle_)
+          {
+            handle_.destroy();
+          }
+        }
+
+        bool await_ready() const noexcept
+        {
+          return false;
+        }
+
+        template<class Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> continuation) noexcept
+        {
+          promise_type& promise = handle_.promise();
+          promise.continuation_ = continuation;
+          promise.parent_ = &continuation.promise();
+
+          return handle_;
+        }
+
+        T await_resume()
+        {
+          return detail::take_await_result<T>(handle_.promise().result_);
+        }
+
+      private:
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    explicit task(std::coroutine_handle<promise_type> handle) noexcept
+      : handle_(handle)
+    {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+
+} // end execution
+
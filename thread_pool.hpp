@@ -0,0 +1,942 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include "execution.hpp"
+#include "intrusive_queue.hpp"
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "topology.hpp"
+#include <utility>
+#include <vector>
+
+
+namespace detail
+{
+
+
+// a Chase-Lev work-stealing deque of task_base*
+// the owning worker pushes and pops at the bottom (LIFO) while thieves steal from the top (FIFO)
+//
+// see Lê, Pop, Cohen & Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models", PPoPP 2013
+class work_stealing_deque
+{
+  public:
+    explicit work_stealing_deque(std::size_t capacity = 256)
+      : top_(0),
+        bottom_(0),
+        buffer_(nullptr)
+    {
+      retired_.push_back(std::make_unique<buffer>(capacity));
+      buffer_.store(retired_.back().get(), std::memory_order_relaxed);
+    }
+
+    // only the owner may call push
+    void push(task_base* task)
+    {
+      std::int64_t b = bottom_.load(std::memory_order_relaxed);
+      std::int64_t t = top_.load(std::memory_order_acquire);
+      buffer* a = buffer_.load(std::memory_order_relaxed);
+
+      if(b - t > static_cast<std::int64_t>(a->capacity_) - 1)
+      {
+        a = grow(a, t, b);
+      }
+
+      a->put(b, task);
+      std::atomic_thread_fence(std::memory_order_release);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // only the owner may call pop
+    task_base* pop() noexcept
+    {
+      std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+      buffer* a = buffer_.load(std::memory_order_relaxed);
+      bottom_.store(b, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      std::int64_t t = top_.load(std::memory_order_relaxed);
+
+      task_base* result = nullptr;
+
+      if(t <= b)
+      {
+        result = a->get(b);
+
+        if(t == b)
+        {
+          // the last element is contended with thieves
+          if(!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+          {
+            result = nullptr;
+          }
+
+          bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+      }
+      else
+      {
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+
+      return result;
+    }
+
+    // any thread may call steal
+    task_base* steal() noexcept
+    {
+      std::int64_t t = top_.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      std::int64_t b = bottom_.load(std::memory_order_acquire);
+
+      if(t < b)
+      {
+        buffer* a = buffer_.load(std::memory_order_acquire);
+        task_base* result = a->get(t);
+
+        if(top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+          return result;
+        }
+      }
+
+      return nullptr;
+    }
+
+  private:
+    struct buffer
+    {
+      std::size_t capacity_;
+      std::unique_ptr<std::atomic<task_base*>[]> slots_;
+
+      explicit buffer(std::size_t capacity)
+        : capacity_(capacity),
+          slots_(new std::atomic<task_base*>[capacity])
+      {}
+
+      task_base* get(std::int64_t i) const noexcept
+      {
+        return slots_[static_cast<std::size_t>(i) % capacity_].load(std::memory_order_relaxed);
+      }
+
+      void put(std::int64_t i, task_base* task) noexcept
+      {
+        slots_[static_cast<std::size_t>(i) % capacity_].store(task, std::memory_order_relaxed);
+      }
+    };
+
+    buffer* grow(buffer* old, std::int64_t t, std::int64_t b)
+    {
+      retired_.push_back(std::make_unique<buffer>(2 * old->capacity_));
+      buffer* result = retired_.back().get();
+
+      for(std::int64_t i = t; i < b; ++i)
+      {
+        result->put(i, old->get(i));
+      }
+
+      // old buffers are retained until the deque is destroyed because thieves may still be reading them
+      buffer_.store(result, std::memory_order_release);
+      return result;
+    }
+
+    alignas(64) std::atomic<std::int64_t> top_;
+    alignas(64) std::atomic<std::int64_t> bottom_;
+    std::atomic<buffer*> buffer_;
+    std::vector<std::unique_ptr<buffer>> retired_;
+};
+
+
+// a mutex-protected queue through which work enters a thread_pool from outside its workers
+// each is aligned to its own cache line, so that threads using neighboring queues do not contend
+class alignas(64) injection_queue
+{
+  public:
+    void push(task_base* task)
+    {
+      std::lock_guard lock(mutex_);
+      queue_.push_back(task);
+      size_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void push(intrusive_queue&& tasks, std::size_t num_tasks)
+    {
+      std::lock_guard lock(mutex_);
+      queue_.append(std::move(tasks));
+      size_.fetch_add(num_tasks, std::memory_order_relaxed);
+    }
+
+    task_base* pop()
+    {
+      if(size_.load(std::memory_order_relaxed) == 0)
+      {
+        return nullptr;
+      }
+
+      std::lock_guard lock(mutex_);
+
+      task_base* result = queue_.pop_front();
+
+      if(result)
+      {
+        size_.fetch_sub(1, std::memory_order_relaxed);
+      }
+
+      return result;
+    }
+
+  private:
+    std::mutex mutex_;
+    intrusive_queue queue_;
+    std::atomic<std::size_t> size_{0};
+};
+
+
+} // end detail
+
+
+// thread_pool is a work-stealing execution context
+//
+// each worker owns a work_stealing_deque; work submitted from a worker is pushed onto that
+// worker's deque, while work submitted from other threads goes through an injection queue
+// idle workers steal from randomly chosen victims before going to sleep
+//
+// executors carry no thread-specific state, and compare equal whenever their pool and node do.
+// instead, each enqueue resolves the calling thread through a thread_local slot: a worker's
+// own work goes to its deque, and each outside thread is assigned one of the pool's injection
+// queues, one per worker, so that threads submitting concurrently do not contend on one lock.
+// a worker drains its own injection queue before the others
+//
+// a thread_pool constructed from a topology runs one worker pinned to each of its cpus and
+// groups workers by NUMA node. the pool's nodes are the topology's nodes which have cpus, in order,
+// so a memory-only node has no index of its own; node_id(node) names the topology node behind one:
+//   * executor(node) narrows work to a node: it enters through that node's own injection queue,
+//     which only the node's workers drain
+//   * idle workers steal from victims on their own node before those on other nodes
+//   * each worker constructs its deque after pinning itself, so that its storage, and the
+//     storage its thread_caching_pool hands out for operation states, is first touched on its node
+//
+// narrowing is a placement hint rather than a guarantee: a worker on another node may still
+// steal narrowed work from a deque once its own node has run dry
+class thread_pool
+{
+  public:
+    static constexpr std::size_t any_node = static_cast<std::size_t>(-1);
+
+    explicit thread_pool(std::size_t num_threads = std::thread::hardware_concurrency())
+      : thread_pool(std::vector<placement>(num_threads ? num_threads : 1, placement{0, no_cpu, 0}))
+    {}
+
+    explicit thread_pool(const topology& t)
+      : thread_pool(placements(t))
+    {}
+
+    thread_pool(const thread_pool&) = delete;
+
+    // outstanding work is completed before the destructor returns
+    ~thread_pool()
+    {
+      {
+        std::lock_guard lock(sleep_mutex_);
+        stopping_ = true;
+      }
+
+      for(node_state& node : nodes_)
+      {
+        node.sleep_cv_.notify_all();
+      }
+
+      for(std::thread& t : threads_)
+      {
+        t.join();
+      }
+    }
+
+    std::size_t num_threads() const noexcept
+    {
+      return workers_.size();
+    }
+
+    std::size_t num_nodes() const noexcept
+    {
+      return nodes_.size();
+    }
+
+    // the id_ of the topology node whose cpus node's workers run on, or 0 without a topology
+    std::size_t node_id(std::size_t node) const noexcept
+    {
+      return nodes_[node].id_;
+    }
+
+    // node must be any_node or less than num_nodes()
+    void enqueue(detail::task_base* task, std::size_t node = any_node) const
+    {
+      const_cast<thread_pool*>(this)->enqueue_impl(task, node);
+    }
+
+    // enqueues num_tasks tasks while taking the injection lock at most once
+    // either every task is enqueued, or enqueue throws having enqueued none of them
+    void enqueue(detail::intrusive_queue&& tasks, std::size_t num_tasks, std::size_t node = any_node) const
+    {
+      const_cast<thread_pool*>(this)->enqueue_impl(std::move(tasks), num_tasks, node);
+    }
+
+
+    // a task_operation enqueued upon the node its sender was narrowed to
+    template<execution::receiver_of R>
+    struct operation : detail::task_operation<thread_pool, R>
+    {
+      std::size_t node_;
+
+      template<class OtherR>
+      operation(const thread_pool& pool, std::size_t node, OtherR&& r)
+        : detail::task_operation<thread_pool, R>(pool, std::forward<OtherR>(r)),
+          node_(node)
+      {}
+
+      void start() noexcept
+      {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+        this->context_.enqueue(this, node_);
+#else
+        try
+        {
+          this->context_.enqueue(this, node_);
+        }
+        catch(...)
+        {
+          execution::set_error(std::move(this->receiver_), std::current_exception());
+        }
+#endif
+      }
+    };
+
+
+    struct sender_type
+    {
+      template<template<class...> class Tuple, template<class...> class Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template<template<class...> class Variant>
+      using error_types = Variant<execution::error_type>;
+
+      static constexpr bool sends_done = true;
+
+      const thread_pool& pool_;
+      std::size_t node_ = any_node;
+
+      template<execution::receiver_of R>
+      operation<R> connect(R&& r) const
+      {
+        return {pool_, node_, std::forward<R>(r)};
+      }
+
+      template<class Rs>
+        requires execution::receiver_of<execution::detail::range_value_t<Rs>>
+      void submit_batch(Rs&& receivers) const
+      {
+        using submit_receiver = execution::detail::submit_receiver<const sender_type&, execution::detail::range_value_t<Rs>>;
+
+        detail::enqueue_batch(node_view{pool_, node_}, receivers, [this](auto&& r)
+        {
+          return &submit_receiver::make(*this, std::move(r))->state_;
+        });
+      }
+    };
+
+
+    struct executor_type
+    {
+      const thread_pool* pool_;
+      std::size_t node_ = any_node;
+
+      // returns an executor whose work is placed on the given node's workers
+      executor_type on_node(std::size_t node) const
+      {
+        return pool_->executor(node);
+      }
+
+      template<class F>
+        requires invocable<remove_cvref_t<F>&>
+      void execute(F&& f) const
+      {
+        using task_type = detail::invocable_task<remove_cvref_t<F>>;
+
+        task_type* task = task_type::make(std::forward<F>(f));
+
+#if defined(EXECUTION_NO_EXCEPTIONS)
+        pool_->enqueue(task, node_);
+#else
+        try
+        {
+          pool_->enqueue(task, node_);
+        }
+        catch(...)
+        {
+          task_type::destroy(task);
+          throw;
+        }
+#endif
+      }
+
+      template<class Fs>
+        requires invocable<execution::detail::range_value_t<Fs>&>
+      void execute_batch(Fs&& fs) const
+      {
+        detail::enqueue_batch(node_view{*pool_, node_}, fs, [](auto&& f)
+        {
+          return detail::invocable_task<remove_cvref_t<decltype(f)>>::make(std::move(f));
+        });
+      }
+
+      // partitions [0, n) once: a single shared state holds f and one task per worker,
+      // and each task claims grain-sized ranges of indices until none remain
+      template<class F>
+        requires invocable<remove_cvref_t<F>&, std::size_t>
+      void bulk_execute(F&& f, std::size_t n) const
+      {
+        if(n == 0)
+        {
+          return;
+        }
+
+        std::size_t num_workers = node_ == any_node ? pool_->num_threads() : pool_->nodes_[node_].num_workers_;
+        std::size_t num_tasks = std::min(n, num_workers);
+
+        auto state = std::make_unique<bulk_state<remove_cvref_t<F>>>(std::forward<F>(f), n, num_tasks);
+
+        detail::intrusive_queue tasks;
+
+        for(auto& task : state->tasks_)
+        {
+          tasks.push_back(&task);
+        }
+
+        pool_->enqueue(std::move(tasks), num_tasks, node_);
+
+        // once enqueued, the tasks own the state, and the last of them to finish deletes it
+        state.release();
+      }
+
+      sender_type schedule() const noexcept
+      {
+        return {*pool_, node_};
+      }
+
+      friend bool operator==(const executor_type& a, const executor_type& b)
+      {
+        return a.pool_ == b.pool_ and a.node_ == b.node_;
+      }
+
+      friend bool operator!=(const executor_type& a, const executor_type& b)
+      {
+        return !(a == b);
+      }
+    };
+
+    // node must be any_node or less than num_nodes()
+    executor_type executor(std::size_t node = any_node) const
+    {
+      if(node != any_node and node >= num_nodes())
+      {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+        std::terminate();
+#else
+        throw std::out_of_range("thread_pool::executor: no such node");
+#endif
+      }
+
+      return {this, node};
+    }
+
+  private:
+    static constexpr std::size_t no_cpu = static_cast<std::size_t>(-1);
+
+    // where a worker runs: the index of its node within the pool, the cpu it is pinned to, if any,
+    // and the id_ of its topology node
+    struct placement
+    {
+      std::size_t node_;
+      std::size_t cpu_;
+      std::size_t node_id_;
+    };
+
+    // nodes without cpus are skipped rather than given a node no worker would drain
+    static std::vector<placement> placements(const topology& t)
+    {
+      std::vector<placement> result;
+      std::size_t num_nodes = 0;
+
+      for(const topology::node& n : t.nodes())
+      {
+        if(n.cpus_.empty())
+        {
+          continue;
+        }
+
+        for(std::size_t cpu : n.cpus_)
+        {
+          result.push_back({num_nodes, cpu, n.id_});
+        }
+
+        ++num_nodes;
+      }
+
+      if(result.empty())
+      {
+        result.push_back({0, no_cpu, t.nodes().empty() ? 0 : t.nodes().front().id_});
+      }
+
+      return result;
+    }
+
+    // workers are grouped by node, so that each node's workers are contiguous in workers_
+    explicit thread_pool(std::vector<placement> placements)
+      : workers_(placements.size()),
+        nodes_(placements.back().node_ + 1),
+        started_(static_cast<std::ptrdiff_t>(placements.size() + 1)),
+        injection_queues_(placements.size())
+    {
+      for(std::size_t i = 0; i < placements.size(); ++i)
+      {
+        node_state& node = nodes_[placements[i].node_];
+
+        if(node.num_workers_ == 0)
+        {
+          node.first_worker_ = i;
+          node.id_ = placements[i].node_id_;
+        }
+
+        ++node.num_workers_;
+      }
+
+      threads_.reserve(placements.size());
+
+      for(std::size_t i = 0; i < placements.size(); ++i)
+      {
+        threads_.emplace_back([this,i,p = placements[i]]{ run(i, p); });
+      }
+
+      // workers may steal from one another only once every worker exists
+      started_.arrive_and_wait();
+    }
+
+    // a view of the pool which enqueues upon a single node, for use with detail::enqueue_batch
+    struct node_view
+    {
+      const thread_pool& pool_;
+      std::size_t node_;
+
+      void enqueue(detail::intrusive_queue&& tasks, std::size_t num_tasks) const
+      {
+        pool_.enqueue(std::move(tasks), num_tasks, node_);
+      }
+    };
+
+    template<class F>
+    struct bulk_state
+    {
+      struct task : detail::task_base
+      {
+        bulk_state* state_;
+
+        explicit task(bulk_state* state) noexcept
+          : detail::task_base(&bulk_state::execute),
+            state_(state)
+        {}
+      };
+
+      F f_;
+      std::size_t n_;
+      std::size_t grain_size_;
+      std::atomic<std::size_t> next_index_;
+      std::atomic<std::size_t> num_outstanding_tasks_;
+      std::vector<task> tasks_;
+
+      template<class OtherF>
+      bulk_state(OtherF&& f, std::size_t n, std::size_t num_tasks)
+        : f_(std::forward<OtherF>(f)),
+          n_(n),
+          // several grains per task lets fast workers take over the indices of slow ones
+          grain_size_(std::max<std::size_t>(1, n / (8 * num_tasks))),
+          next_index_(0),
+          num_outstanding_tasks_(num_tasks)
+      {
+        tasks_.reserve(num_tasks);
+
+        for(std::size_t i = 0; i < num_tasks; ++i)
+        {
+          tasks_.emplace_back(this);
+        }
+      }
+
+      static void execute(detail::task_base* t) noexcept
+      {
+        bulk_state* self = static_cast<task*>(t)->state_;
+
+        for(std::size_t begin = self->next_index_.fetch_add(self->grain_size_, std::memory_order_relaxed);
+            begin < self->n_;
+            begin = self->next_index_.fetch_add(self->grain_size_, std::memory_order_relaxed))
+        {
+          std::size_t end = std::min(begin + self->grain_size_, self->n_);
+
+          for(std::size_t i = begin; i < end; ++i)
+          {
+            std::invoke(self->f_, i);
+          }
+        }
+
+        if(self->num_outstanding_tasks_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+          delete self;
+        }
+      }
+    };
+
+    struct alignas(64) worker
+    {
+      detail::work_stealing_deque deque_;
+      std::size_t index_ = 0;
+      std::size_t node_ = 0;
+      std::uint64_t rng_state_ = 0;
+    };
+
+    struct alignas(64) node_state
+    {
+      std::size_t id_ = 0;
+      std::size_t first_worker_ = 0;
+      std::size_t num_workers_ = 0;
+      detail::injection_queue injection_queue_;
+      std::condition_variable sleep_cv_;
+      std::atomic<std::size_t> num_sleepers_{0};
+    };
+
+    // identifies the worker, if any, running on the current thread
+    struct current_worker
+    {
+      thread_pool* pool_ = nullptr;
+      worker* worker_ = nullptr;
+    };
+
+    static current_worker& this_thread() noexcept
+    {
+      thread_local current_worker result;
+      return result;
+    }
+
+    // the injection queue upon which the calling thread, which is not one of this pool's workers, enqueues work for any node
+    // a thread is assigned its slot the first time it enqueues upon any pool, and keeps it thereafter
+    detail::injection_queue& outside_queue() noexcept
+    {
+      static std::atomic<std::size_t> next_slot{0};
+      thread_local const std::size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+
+      return injection_queues_[slot % injection_queues_.size()];
+    }
+
+    void enqueue_impl(detail::task_base* task, std::size_t node)
+    {
+      current_worker& current = this_thread();
+
+      if(current.pool_ == this and (node == any_node or node == current.worker_->node_))
+      {
+        current.worker_->deque_.push(task);
+      }
+      else if(node == any_node)
+      {
+        outside_queue().push(task);
+      }
+      else
+      {
+        nodes_[node].injection_queue_.push(task);
+      }
+
+      wake(1, node);
+    }
+
+    void enqueue_impl(detail::intrusive_queue&& tasks, std::size_t num_tasks, std::size_t node)
+    {
+      if(num_tasks == 0)
+      {
+        return;
+      }
+
+      current_worker& current = this_thread();
+
+      if(current.pool_ == this and (node == any_node or node == current.worker_->node_))
+      {
+        for(std::size_t num_pushed = 0; detail::task_base* task = tasks.pop_front(); ++num_pushed)
+        {
+#if defined(EXECUTION_NO_EXCEPTIONS)
+          current.worker_->deque_.push(task);
+#else
+          try
+          {
+            current.worker_->deque_.push(task);
+          }
+          catch(...)
+          {
+            // the deque could not grow, so the rest of the batch is injected instead, which leaves
+            // the caller no partially enqueued batch to unwind
+            detail::intrusive_queue rest;
+            rest.push_back(task);
+            rest.append(std::move(tasks));
+
+            (node == any_node ? outside_queue() : nodes_[node].injection_queue_).push(std::move(rest), num_tasks - num_pushed);
+            break;
+          }
+#endif
+        }
+      }
+      else if(node == any_node)
+      {
+        outside_queue().push(std::move(tasks), num_tasks);
+      }
+      else
+      {
+        nodes_[node].injection_queue_.push(std::move(tasks), num_tasks);
+      }
+
+      wake(num_tasks, node);
+    }
+
+    static std::uint64_t next_random(worker& self) noexcept
+    {
+      // xorshift64
+      std::uint64_t x = self.rng_state_;
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      self.rng_state_ = x;
+
+      return x;
+    }
+
+    // victims on the thief's own node are tried first, since their work's memory is likely local to it
+    detail::task_base* steal(worker& thief) noexcept
+    {
+      std::uint64_t x = next_random(thief);
+
+      const node_state& local = nodes_[thief.node_];
+
+      for(std::size_t i = 0; i < local.num_workers_; ++i)
+      {
+        worker& victim = *workers_[local.first_worker_ + (x + i) % local.num_workers_];
+
+        if(&victim != &thief)
+        {
+          if(detail::task_base* result = victim.deque_.steal())
+          {
+            return result;
+          }
+        }
+      }
+
+      std::size_t n = workers_.size();
+      std::size_t first = static_cast<std::size_t>(x % n);
+
+      for(std::size_t i = 0; i < n; ++i)
+      {
+        worker& victim = *workers_[(first + i) % n];
+
+        if(victim.node_ != thief.node_)
+        {
+          if(detail::task_base* result = victim.deque_.steal())
+          {
+            return result;
+          }
+        }
+      }
+
+      return nullptr;
+    }
+
+    detail::task_base* find_work(worker& self)
+    {
+      if(detail::task_base* result = self.deque_.pop())
+      {
+        return result;
+      }
+
+      if(detail::task_base* result = nodes_[self.node_].injection_queue_.pop())
+      {
+        return result;
+      }
+
+      std::size_t num_queues = injection_queues_.size();
+
+      for(std::size_t i = 0; i < num_queues; ++i)
+      {
+        if(detail::task_base* result = injection_queues_[(self.index_ + i) % num_queues].pop())
+        {
+          return result;
+        }
+      }
+
+      return steal(self);
+    }
+
+    // wakes as many of node's sleeping workers as there are new tasks, up to all of them
+    // returns the number of workers woken
+    std::size_t wake_node(node_state& node, std::size_t num_tasks)
+    {
+      std::size_t num_sleepers = node.num_sleepers_.load(std::memory_order_relaxed);
+
+      if(num_sleepers == 0)
+      {
+        return 0;
+      }
+
+      {
+        std::lock_guard lock(sleep_mutex_);
+        ++wake_epoch_;
+      }
+
+      if(num_tasks >= num_sleepers)
+      {
+        node.sleep_cv_.notify_all();
+        return num_sleepers;
+      }
+
+      for(std::size_t i = 0; i < num_tasks; ++i)
+      {
+        node.sleep_cv_.notify_one();
+      }
+
+      return num_tasks;
+    }
+
+    // wakes as many sleeping workers as there are new tasks on node
+    // work for any node wakes the caller's own node first
+    void wake(std::size_t num_tasks, std::size_t node)
+    {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      if(node != any_node)
+      {
+        wake_node(nodes_[node], num_tasks);
+        return;
+      }
+
+      current_worker& current = this_thread();
+      std::size_t first = current.pool_ == this ? current.worker_->node_ : 0;
+
+      for(std::size_t i = 0; i < nodes_.size() and num_tasks > 0; ++i)
+      {
+        num_tasks -= wake_node(nodes_[(first + i) % nodes_.size()], num_tasks);
+      }
+    }
+
+    // returns nullptr when the pool is stopping and no work remains
+    detail::task_base* wait_for_work(worker& self)
+    {
+      constexpr int num_spins = 64;
+
+      for(int i = 0; i < num_spins; ++i)
+      {
+        if(detail::task_base* result = find_work(self))
+        {
+          return result;
+        }
+
+        std::this_thread::yield();
+      }
+
+      node_state& node = nodes_[self.node_];
+
+      std::unique_lock lock(sleep_mutex_);
+      std::uint64_t epoch = wake_epoch_;
+      node.num_sleepers_.fetch_add(1, std::memory_order_seq_cst);
+      lock.unlock();
+
+      // a producer either observes this sleeper and wakes it, or published its work before the increment above
+      detail::task_base* result = find_work(self);
+
+      lock.lock();
+
+      if(!result)
+      {
+        node.sleep_cv_.wait(lock, [&]{ return wake_epoch_ != epoch or stopping_; });
+      }
+
+      node.num_sleepers_.fetch_sub(1, std::memory_order_relaxed);
+
+      if(!result and stopping_)
+      {
+        lock.unlock();
+        result = find_work(self);
+      }
+
+      return result;
+    }
+
+    void run(std::size_t i, placement p)
+    {
+      if(p.cpu_ != no_cpu)
+      {
+        detail::pin_this_thread(p.cpu_);
+      }
+
+      // allocated only once pinned, so that first touch places the worker's memory on its node
+      workers_[i] = std::make_unique<worker>();
+      workers_[i]->index_ = i;
+      workers_[i]->node_ = p.node_;
+      workers_[i]->rng_state_ = 0x9e3779b97f4a7c15ull * (i + 1);
+
+      started_.arrive_and_wait();
+
+      worker& self = *workers_[i];
+      this_thread() = {this, &self};
+
+      while(true)
+      {
+        detail::task_base* task = find_work(self);
+
+        if(!task)
+        {
+          task = wait_for_work(self);
+        }
+
+        if(!task)
+        {
+          std::lock_guard lock(sleep_mutex_);
+
+          if(stopping_)
+          {
+            break;
+          }
+
+          continue;
+        }
+
+        task->execute();
+      }
+
+      this_thread() = {};
+    }
+
+    std::vector<std::unique_ptr<worker>> workers_;
+    std::vector<node_state> nodes_;
+    std::vector<std::thread> threads_;
+    std::latch started_;
+
+    // work which may run on any node, enqueued by threads outside the pool, one queue per worker
+    std::vector<detail::injection_queue> injection_queues_;
+
+    std::mutex sleep_mutex_;
+    std::uint64_t wake_epoch_ = 0;
+    bool stopping_ = false;
+};
+
+
+static_assert(execution::executor<thread_pool::executor_type>);
+static_assert(execution::scheduler<thread_pool::executor_type>);
+
@@ -0,0 +1,561 @@
+#pragma once
+
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include "execution.hpp"
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+
+namespace detail
+{
+
+
+// timer_node is the intrusive hook embedded in timer_context's operations
+// a pending timer is linked into exactly one slot of the wheel through prev_ and next_
+struct timer_node
+{
+  timer_node* prev_ = nullptr;
+  timer_node* next_ = nullptr;
+  std::uint64_t deadline_ = 0;
+  bool pending_ = false;
+
+  // set when cancellation arrives before the timer was inserted
+  bool cancel_requested_ = false;
+
+  // completes the timer with set_value, or with set_done if it was cancelled
+  void (*complete_)(timer_node*, bool cancelled) noexcept = nullptr;
+};
+
+
+// a hierarchical timing wheel of timer_node
+//
+// each of num_levels levels has num_slots slots; a slot at level l holds the timers whose deadline
+// first differs from the current tick in the l-th group of slot_bits bits. timers cascade to lower
+// levels as the current tick reaches them, so insert and remove are O(1) and each timer is touched
+// at most num_levels times before it expires
+//
+// timer_wheel is not synchronized
+class timer_wheel
+{
+  public:
+    static constexpr int slot_bits = 8;
+    static constexpr int num_slots = 1 << slot_bits;
+    static constexpr int num_levels = 4;
+
+    static constexpr std::uint64_t no_tick = std::numeric_limits<std::uint64_t>::max();
+
+    timer_wheel() noexcept
+    {
+      for(auto& level : slots_)
+      {
+        for(timer_node& sentinel : level)
+        {
+          sentinel.prev_ = sentinel.next_ = &sentinel;
+        }
+      }
+    }
+
+    timer_wheel(const timer_wheel&) = delete;
+
+    std::uint64_t current_tick() const noexcept
+    {
+      return current_tick_;
+    }
+
+    bool empty() const noexcept
+    {
+      return size_ == 0;
+    }
+
+    // node->deadline_ must be no earlier than current_tick()
+    void insert(timer_node* node) noexcept
+    {
+      std::uint64_t difference = node->deadline_ ^ current_tick_;
+
+      int level = difference ? (std::bit_width(difference) - 1) / slot_bits : 0;
+
+      // deadlines beyond the range of the wheel wait in the top level and are reinserted when it comes around
+      if(level >= num_levels)
+      {
+        level = num_levels - 1;
+      }
+
+      timer_node& sentinel = slots_[level][slot_index(node->deadline_, level)];
+
+      node->prev_ = sentinel.prev_;
+      node->next_ = &sentinel;
+      sentinel.prev_->next_ = node;
+      sentinel.prev_ = node;
+
+      ++size_;
+    }
+
+    void remove(timer_node* node) noexcept
+    {
+      node->prev_->next_ = node->next_;
+      node->next_->prev_ = node->prev_;
+      node->prev_ = node->next_ = nullptr;
+
+      --size_;
+    }
+
+    // the earliest tick after current_tick() at which advancing could expire or cascade a timer
+    std::uint64_t next_tick() const noexcept
+    {
+      if(empty())
+      {
+        return no_tick;
+      }
+
+      std::uint64_t boundary = (current_tick_ | (num_slots - 1)) + 1;
+
+      for(std::uint64_t tick = current_tick_ + 1; tick < boundary; ++tick)
+      {
+        if(!slot_empty(0, slot_index(tick, 0)))
+        {
+          return tick;
+        }
+      }
+
+      return boundary;
+    }
+
+    // advances the current tick to tick, passing each expired timer to f
+    template<class F>
+    void advance(std::uint64_t tick, F&& f)
+    {
+      while(current_tick_ < tick)
+      {
+        std::uint64_t next = next_tick();
+
+        if(next > tick)
+        {
+          // nothing happens in between
+          current_tick_ = tick;
+          break;
+        }
+
+        current_tick_ = next;
+
+        // cascade from the highest level whose slot was reached downward
+        for(int level = num_levels - 1; level > 0; --level)
+        {
+          std::uint64_t mask = (std::uint64_t(1) << (level * slot_bits)) - 1;
+
+          if((current_tick_ & mask) == 0)
+          {
+            for_each_removed(level, slot_index(current_tick_, level), [this](timer_node* node)
+            {
+              insert(node);
+            });
+          }
+        }
+
+        for_each_removed(0, slot_index(current_tick_, 0), f);
+      }
+    }
+
+    // removes every timer, passing each to f
+    template<class F>
+    void clear(F&& f)
+    {
+      for(int level = 0; level < num_levels; ++level)
+      {
+        for(int slot = 0; slot < num_slots; ++slot)
+        {
+          for_each_removed(level, slot, f);
+        }
+      }
+    }
+
+  private:
+    static constexpr int slot_index(std::uint64_t tick, int level) noexcept
+    {
+      return static_cast<int>((tick >> (level * slot_bits)) & (num_slots - 1));
+    }
+
+    bool slot_empty(int level, int slot) const noexcept
+    {
+      const timer_node& sentinel = slots_[level][slot];
+      return sentinel.next_ == &sentinel;
+    }
+
+    // unlinks the slot's list before visiting it, so f may reinsert into the same slot
+    template<class F>
+    void for_each_removed(int level, int slot, F&& f)
+    {
+      timer_node& sentinel = slots_[level][slot];
+
+      if(sentinel.next_ == &sentinel)
+      {
+        return;
+      }
+
+      timer_node* node = sentinel.next_;
+      sentinel.prev_->next_ = nullptr;
+      sentinel.prev_ = sentinel.next_ = &sentinel;
+
+      while(node)
+      {
+        timer_node* next = node->next_;
+        node->prev_ = node->next_ = nullptr;
+        --size_;
+        f(node);
+        node = next;
+      }
+    }
+
+    timer_node slots_[num_levels][num_slots];
+    std::uint64_t current_tick_ = 0;
+    std::size_t size_ = 0;
+};
+
+
+} // end detail
+
+
+// timer_context completes scheduled work at or after requested points in time
+//
+// operation states embed a detail::timer_node, so inserting and cancelling a timer never
+// allocates and costs O(1). timers expire on the context's thread with a resolution of tick_duration
+class timer_context
+{
+  public:
+    using clock_type = std::chrono::steady_clock;
+    using time_point = clock_type::time_point;
+    using duration = clock_type::duration;
+
+    using tick_type = std::chrono::milliseconds;
+
+    static constexpr tick_type tick_duration{1};
+
+    timer_context()
+      : epoch_(clock_type::now()),
+        thread_([this]{ run(); })
+    {}
+
+    timer_context(const timer_context&) = delete;
+
+    // timers which have not expired by the time the destructor is called complete with set_done
+    ~timer_context()
+    {
+      {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+      }
+
+      cv_.notify_one();
+      thread_.join();
+    }
+
+    time_point now() const noexcept
+    {
+      return clock_type::now();
+    }
+
+    void insert(detail::timer_node* node, time_point tp) const noexcept
+    {
+      const_cast<timer_context*>(this)->insert_impl(node, tp);
+    }
+
+    // returns true if node was removed before it expired
+    bool cancel(detail::timer_node* node) const noexcept
+    {
+      return const_cast<timer_context*>(this)->cancel_impl(node);
+    }
+
+
+    template<execution::receiver_of R>
+    struct operation : detail::timer_node
+    {
+      struct cancel_callback
+      {
+        operation* self_;
+
+        void operator()() const noexcept
+        {
+          self_->cancel();
+        }
+      };
+
+      using stop_callback_type = typename execution::stop_token_of_t<R>::template callback_type<cancel_callback>;
+
+      const timer_context& context_;
+      time_point time_point_;
+      remove_cvref_t<R> receiver_;
+      std::optional<stop_callback_type> stop_callback_;
+
+      template<class OtherR>
+      operation(const timer_context& context, time_point tp, OtherR&& r)
+        : context_(context),
+          time_point_(tp),
+          receiver_(std::forward<OtherR>(r))
+      {
+        complete_ = &operation::complete;
+      }
+
+      // the context links this object into its wheel, so it must not move
+      operation(operation&&) = delete;
+
+      // a stop request on the receiver's token cancels the timer as soon as it is made
+      void start() noexcept
+      {
+        stop_callback_.emplace(execution::get_stop_token(receiver_), cancel_callback{this});
+        context_.insert(this, time_point_);
+      }
+
+      // completes the receiver with set_done if the timer has not yet expired
+      void cancel() noexcept
+      {
+        if(context_.cancel(this))
+        {
+          complete(this, true);
+        }
+      }
+
+      static void complete(detail::timer_node* node, bool cancelled) noexcept
+      {
+        operation& self = *static_cast<operation*>(node);
+
+        self.stop_callback_.reset();
+
+        if(cancelled)
+        {
+          execution::set_done(std::move(self.receiver_));
+          return;
+        }
+
+        execution::detail::set_value_or_error(std::move(self.receiver_));
+      }
+    };
+
+
+    struct sender_type
+    {
+      template<template<class...> class Tuple, template<class...> class Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template<template<class...> class Variant>
+      using error_types = Variant<execution::error_type>;
+
+      static constexpr bool sends_done = true;
+
+      const timer_context& context_;
+      time_point time_point_;
+
+      template<execution::receiver_of R>
+      operation<R> connect(R&& r) const
+      {
+        return {context_, time_point_, std::forward<R>(r)};
+      }
+    };
+
+
+    struct scheduler_type
+    {
+      const timer_context* context_;
+
+      sender_type schedule() const noexcept
+      {
+        return {*context_, time_point::min()};
+      }
+
+      sender_type schedule_at(time_point tp) const noexcept
+      {
+        return {*context_, tp};
+      }
+
+      time_point now() const noexcept
+      {
+        return context_->now();
+      }
+
+      friend bool operator==(const scheduler_type& a, const scheduler_type& b)
+      {
+        return a.context_ == b.context_;
+      }
+
+      friend bool operator!=(const scheduler_type& a, const scheduler_type& b)
+      {
+        return !(a == b);
+      }
+    };
+
+    scheduler_type scheduler() const
+    {
+      return {this};
+    }
+
+  private:
+    std::uint64_t now_tick() const noexcept
+    {
+      return std::chrono::duration_cast<tick_type>(clock_type::now() - epoch_).count();
+    }
+
+    std::uint64_t deadline_tick(time_point tp) const noexcept
+    {
+      if(tp <= epoch_)
+      {
+        return 0;
+      }
+
+      return std::chrono::ceil<tick_type>(tp - epoch_).count();
+    }
+
+    // requires mutex_ be held
+    void push_ready(detail::timer_node* node) noexcept
+    {
+      node->pending_ = false;
+      node->next_ = nullptr;
+
+      if(ready_tail_)
+      {
+        ready_tail_->next_ = node;
+      }
+      else
+      {
+        ready_head_ = node;
+      }
+
+      ready_tail_ = node;
+    }
+
+    void insert_impl(detail::timer_node* node, time_point tp) noexcept
+    {
+      node->deadline_ = deadline_tick(tp);
+
+      std::unique_lock lock(mutex_);
+
+      if(node->cancel_requested_)
+      {
+        lock.unlock();
+        node->complete_(node, true);
+        return;
+      }
+
+      if(node->deadline_ <= wheel_.current_tick())
+      {
+        push_ready(node);
+      }
+      else
+      {
+        node->pending_ = true;
+        wheel_.insert(node);
+
+        if(node->deadline_ >= wake_tick_)
+        {
+          // the thread is awake, or will wake in time anyway
+          return;
+        }
+      }
+
+      lock.unlock();
+      cv_.notify_one();
+    }
+
+    bool cancel_impl(detail::timer_node* node) noexcept
+    {
+      std::lock_guard lock(mutex_);
+
+      if(!node->pending_)
+      {
+        // if node has yet to be inserted, insert_impl completes it instead
+        node->cancel_requested_ = true;
+        return false;
+      }
+
+      node->pending_ = false;
+      wheel_.remove(node);
+      return true;
+    }
+
+    void run() noexcept
+    {
+      std::unique_lock lock(mutex_);
+
+      while(true)
+      {
+        wheel_.advance(now_tick(), [this](detail::timer_node* node)
+        {
+          push_ready(node);
+        });
+
+        if(ready_head_)
+        {
+          detail::timer_node* node = std::exchange(ready_head_, nullptr);
+          ready_tail_ = nullptr;
+
+          lock.unlock();
+
+          while(node)
+          {
+            detail::timer_node* next = node->next_;
+            node->complete_(node, false);
+            node = next;
+          }
+
+          lock.lock();
+          continue;
+        }
+
+        if(stopping_)
+        {
+          break;
+        }
+
+        wake_tick_ = wheel_.next_tick();
+
+        if(wake_tick_ == detail::timer_wheel::no_tick)
+        {
+          cv_.wait(lock);
+        }
+        else
+        {
+          cv_.wait_until(lock, epoch_ + wake_tick_ * tick_duration);
+        }
+
+        // while awake, inserters need not notify
+        wake_tick_ = 0;
+      }
+
+      detail::timer_node* cancelled = nullptr;
+
+      wheel_.clear([&](detail::timer_node* node)
+      {
+        node->pending_ = false;
+        node->next_ = cancelled;
+        cancelled = node;
+      });
+
+      lock.unlock();
+
+      while(cancelled)
+      {
+        detail::timer_node* next = cancelled->next_;
+        cancelled->complete_(cancelled, true);
+        cancelled = next;
+      }
+    }
+
+    const time_point epoch_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    detail::timer_wheel wheel_;
+    detail::timer_node* ready_head_ = nullptr;
+    detail::timer_node* ready_tail_ = nullptr;
+    std::uint64_t wake_tick_ = 0;
+    bool stopping_ = false;
+
+    std::thread thread_;
+};
+
+
+static_assert(execution::scheduler<timer_context::scheduler_type>);
+
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace detail
+{
+
+
+// parses a Linux cpu list such as "0-3,8,10-11"
+inline std::vector<std::size_t> parse_cpu_list(const std::string& list)
+{
+  std::vector<std::size_t> result;
+
+  std::size_t i = 0;
+
+  auto parse_number = [&]
+  {
+    std::size_t number = 0;
+
+    while(i < list.size() and std::isdigit(static_cast<unsigned char>(list[i])))
+    {
+      number = 10 * number + (list[i] - '0');
+      ++i;
+    }
+
+    return number;
+  };
+
+  while(i < list.size() and std::isdigit(static_cast<unsigned char>(list[i])))
+  {
+    std::size_t first = parse_number();
+    std::size_t last = first;
+
+    if(i < list.size() and list[i] == '-')
+    {
+      ++i;
+      last = parse_number();
+    }
+
+    for(std::size_t cpu = first; cpu <= last; ++cpu)
+    {
+      result.push_back(cpu);
+    }
+
+    if(i < list.size() and list[i] == ',')
+    {
+      ++i;
+    }
+  }
+
+  return result;
+}
+
+
+// the cpus the calling thread may run on
+inline std::vector<std::size_t> allowed_cpus()
+{
+  std::vector<std::size_t> result;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  if(sched_getaffinity(0, sizeof(set), &set) == 0)
+  {
+    for(std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+      if(CPU_ISSET(cpu, &set))
+      {
+        result.push_back(cpu);
+      }
+    }
+  }
+  else
+  {
+    for(std::size_t cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+    {
+      result.push_back(cpu);
+    }
+  }
+
+  return result;
+}
+
+
+// restricts the calling thread to a single cpu
+// returns false if the cpu cannot be used, in which case the thread's affinity is unchanged
+inline bool pin_this_thread(std::size_t cpu) noexcept
+{
+  if(cpu >= CPU_SETSIZE)
+  {
+    return false;
+  }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+
+} // end detail
+
+
+// topology describes the NUMA nodes of a machine and the cpus belonging to each
+class topology
+{
+  public:
+    struct node
+    {
+      std::size_t id_;
+      std::vector<std::size_t> cpus_;
+    };
+
+    explicit topology(std::vector<node> nodes)
+      : nodes_(std::move(nodes))
+    {}
+
+    // reads the machine's nodes from /sys/devices/system/node, keeping only the cpus this thread may run on
+    // a machine without NUMA information is described as a single node
+    static topology system()
+    {
+      std::vector<std::size_t> allowed = detail::allowed_cpus();
+      std::vector<node> nodes;
+
+      // the directory is read with error codes rather than exceptions, so that a machine without it is
+      // described as a single node even when exceptions are disabled
+      std::error_code ec;
+      std::filesystem::directory_iterator entries("/sys/devices/system/node", ec);
+
+      for(; !ec and entries != std::filesystem::directory_iterator(); entries.increment(ec))
+      {
+        const std::filesystem::directory_entry& entry = *entries;
+
+        std::string name = entry.path().filename().string();
+
+        if(name.size() <= 4 or name.compare(0, 4, "node") != 0 or
+           !std::all_of(name.begin() + 4, name.end(), [](unsigned char c){ return std::isdigit(c); }))
+        {
+          continue;
+        }
+
+        std::ifstream file(entry.path() / "cpulist");
+        std::string list;
+        std::getline(file, list);
+
+        node n{std::stoul(name.substr(4)), {}};
+
+        for(std::size_t cpu : detail::parse_cpu_list(list))
+        {
+          if(std::binary_search(allowed.begin(), allowed.end(), cpu))
+          {
+            n.cpus_.push_back(cpu);
+          }
+        }
+
+        // memory-only nodes have no cpus to run workers on
+        if(!n.cpus_.empty())
+        {
+          nodes.push_back(std::move(n));
+        }
+      }
+
+      // a listing interrupted by an error is discarded
+      if(ec)
+      {
+        nodes.clear();
+      }
+
+      if(nodes.empty())
+      {
+        nodes.push_back(node{0, std::move(allowed)});
+      }
+
+      std::sort(nodes.begin(), nodes.end(), [](const node& a, const node& b)
+      {
+        return a.id_ < b.id_;
+      });
+
+      return topology{std::move(nodes)};
+    }
+
+    const std::vector<node>& nodes() const noexcept
+    {
+      return nodes_;
+    }
+
+    std::size_t num_cpus() const noexcept
+    {
+      std::size_t result = 0;
+
+      for(const node& n : nodes_)
+      {
+        result += n.cpus_.size();
+      }
+
+      return result;
+    }
+
+  private:
+    std::vector<node> nodes_;
+};
+